@@ -0,0 +1,137 @@
+#include "AllocationCounter.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <new>
+
+// Counted per thread so that one thread's hot path is not polluted by what
+//   the others are doing
+static thread_local uint64_t allocationCount {0};
+
+uint64_t getAllocationCount()
+{
+    return allocationCount;
+}
+
+void* operator new(std::size_t size)
+{
+    allocationCount++;
+    if (size == 0)
+        size = 1;
+    if (auto ptr = std::malloc(size))
+        return ptr;
+
+    throw std::bad_alloc {};
+}
+
+void* operator new[](std::size_t size)
+{
+    return ::operator new(size);
+}
+
+void* operator new(std::size_t size, std::nothrow_t const&) noexcept
+{
+    try
+    {
+        return ::operator new(size);
+    }
+    catch (std::bad_alloc const&)
+    {
+        return nullptr;
+    }
+}
+
+void* operator new[](std::size_t size, std::nothrow_t const&) noexcept
+{
+    return ::operator new(size, std::nothrow);
+}
+
+// Over-aligned types come through these instead, and would otherwise go
+//   uncounted
+void* operator new(std::size_t size, std::align_val_t alignment)
+{
+    allocationCount++;
+    auto align = static_cast<std::size_t>(alignment);
+    // aligned_alloc wants the size to be a multiple of the alignment
+    size = (std::max<std::size_t>(size, 1) + align - 1) / align * align;
+#ifdef _WIN32
+    if (auto ptr = _aligned_malloc(size, align))
+#else
+    if (auto ptr = std::aligned_alloc(align, size))
+#endif
+        return ptr;
+
+    throw std::bad_alloc {};
+}
+
+void* operator new[](std::size_t size, std::align_val_t alignment)
+{
+    return ::operator new(size, alignment);
+}
+
+void* operator new(std::size_t size, std::align_val_t alignment, std::nothrow_t const&) noexcept
+{
+    try
+    {
+        return ::operator new(size, alignment);
+    }
+    catch (std::bad_alloc const&)
+    {
+        return nullptr;
+    }
+}
+
+void* operator new[](std::size_t size, std::align_val_t alignment, std::nothrow_t const&) noexcept
+{
+    return ::operator new(size, alignment, std::nothrow);
+}
+
+void operator delete(void* ptr) noexcept
+{
+    std::free(ptr);
+}
+
+void operator delete[](void* ptr) noexcept
+{
+    std::free(ptr);
+}
+
+void operator delete(void* ptr, std::size_t) noexcept
+{
+    std::free(ptr);
+}
+
+void operator delete[](void* ptr, std::size_t) noexcept
+{
+    std::free(ptr);
+}
+
+// Windows keeps aligned blocks apart from malloc's, so they need their own free
+static void freeAligned(void* ptr) noexcept
+{
+#ifdef _WIN32
+    _aligned_free(ptr);
+#else
+    std::free(ptr);
+#endif
+}
+
+void operator delete(void* ptr, std::align_val_t) noexcept
+{
+    freeAligned(ptr);
+}
+
+void operator delete[](void* ptr, std::align_val_t) noexcept
+{
+    freeAligned(ptr);
+}
+
+void operator delete(void* ptr, std::size_t, std::align_val_t) noexcept
+{
+    freeAligned(ptr);
+}
+
+void operator delete[](void* ptr, std::size_t, std::align_val_t) noexcept
+{
+    freeAligned(ptr);
+}
@@ -0,0 +1,23 @@
+#pragma once
+
+#include <cstdint>
+
+// Number of allocations the calling thread has made through the global
+//   operator new
+uint64_t getAllocationCount();
+
+class AllocationScope
+{
+private:
+    uint64_t startCount;
+
+public:
+    AllocationScope(): startCount(getAllocationCount())
+    {
+    }
+
+    inline auto getCount() const
+    {
+        return getAllocationCount() - this->startCount;
+    }
+};
@@ -0,0 +1,762 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstdint>
+#include <cstring>
+#include <random>
+#include <ranges>
+#include <tuple>
+
+#include <SFML/Graphics.hpp>
+
+#include "Minesweeper.h"
+
+// Square board with its size and mine count fixed at compile time, for the
+//   presets that get simulated over and over. Plays by exactly the same rules
+//   as GameBoard, but every tile set is a bitboard with one word per row, so
+//   counting, filling and win checks work on a whole row at a time.
+template<int32_t Width, int32_t Height, int32_t Mines>
+class BitBoard
+{
+    static_assert(Width > 0 and Width <= 64, "Rows must fit in one word");
+    static_assert(Height > 0 and Height <= 64, "Fills track rows in one word");
+    static_assert(Mines > 0 and Mines < Width * Height);
+
+private:
+    using Row  = uint64_t;
+    using Rows = std::array<Row, Height>;
+
+    static constexpr Row ROW_MASK {Width == 64 ? ~Row {0} : (Row {1} << Width) - 1};
+
+    // Byte i of entry b is bit i of b, to turn eight bits of a row into eight
+    //   tiles' worth of flags
+    static constexpr auto SPREAD_BITS = []
+    {
+        std::array<uint64_t, 256> table {};
+        for (auto bits: std::views::iota(0, 256))
+            for (auto i: std::views::iota(0, 8))
+                if (bits >> i & 1)
+                    table[bits] |= uint64_t {1} << (8 * i);
+        return table;
+    }();
+
+    Rows mines;
+    Rows uncovered;
+    Rows flagged;
+    // Covered tiles drawn pressed while the left button is held
+    Rows telegraphed {};
+    // Adjacent mine counts, bit-sliced: bit x of countPlanes[i][y] is bit i
+    //   of the count for tile (x, y)
+    std::array<Rows, 4> countPlanes;
+    // Safe tiles with no adjacent mines
+    Rows empty;
+    // Count and mine bit of every tile, packed as on a GameBoard. These only
+    //   change along with the mines, so publishing just adds the state bits.
+    std::array<uint8_t, Width * Height> layout;
+
+    // Kept up to date from popcounts as tiles change, so win and loss checks
+    //   do not need to look at the board
+    int32_t numCoveredSafe;
+    bool mineDetonated;
+
+    GameState gameState;
+    bool clockStarted;
+    sf::Clock gameClock;
+    sf::Time finishTime;
+    int32_t numFlags;
+    int32_t lastClickedX {-1};
+    int32_t lastClickedY {-1};
+    GameStats stats;
+
+    // What the last delta left a viewer seeing, so the next one is the
+    //   difference. Only kept up while recording.
+    bool recordingChanges {false};
+    Rows shownUncovered {};
+    Rows shownFlagged {};
+    bool shownLost {false};
+
+    std::mt19937_64 rng {std::random_device {}()};
+
+    static constexpr Row spreadRow(Row row)
+    {
+        return (row | row << 1 | row >> 1) & ROW_MASK;
+    }
+
+    static constexpr Row getRow(Rows const& rows, int32_t y)
+    {
+        return y < 0 or y >= Height ? 0 : rows[y];
+    }
+
+    // Every tile in or next to a tile of rows
+    static constexpr Rows dilate(Rows const& rows)
+    {
+        Rows result;
+        for (auto y: std::views::iota(0, Height))
+            result[y] = spreadRow(getRow(rows, y - 1) | rows[y] | getRow(rows, y + 1));
+
+        return result;
+    }
+
+    static constexpr Row bit(int32_t x)
+    {
+        return Row {1} << x;
+    }
+
+    // Sums the eight neighbour masks of row y of rows with a carry-save adder
+    //   tree, giving the counts for the whole row bit-sliced into four planes
+    static constexpr std::array<Row, 4> sumNeighbours(Rows const& rows, int32_t y)
+    {
+        auto addFull = [](Row a, Row b, Row c, Row& sum, Row& carry)
+        {
+            auto partial = a ^ b;
+            sum          = partial ^ c;
+            carry        = (a & b) | (partial & c);
+        };
+
+        auto above = getRow(rows, y - 1);
+        auto row   = rows[y];
+        auto below = getRow(rows, y + 1);
+
+        Row sum0, sum1, sum2, carry0, carry1, carry2;
+        addFull(above << 1, above, above >> 1, sum0, carry0);
+        addFull(below << 1, below, below >> 1, sum1, carry1);
+        sum2   = (row << 1) ^ (row >> 1);
+        carry2 = (row << 1) & (row >> 1);
+
+        Row ones, twos, fours, carry3, carry4;
+        addFull(sum0, sum1, sum2, ones, carry3);
+        addFull(carry0, carry1, carry2, twos, carry4);
+        fours       = carry4 ^ (twos & carry3);
+        auto eights = carry4 & twos & carry3;
+        twos ^= carry3;
+
+        return {ones & ROW_MASK, twos & ROW_MASK, fours & ROW_MASK, eights & ROW_MASK};
+    }
+
+    void countNeighbours()
+    {
+        for (auto y: std::views::iota(0, Height))
+        {
+            auto planes = sumNeighbours(this->mines, y);
+            for (auto i: std::views::iota(0, 4))
+                this->countPlanes[i][y] = planes[i];
+            this->empty[y] = ~(planes[0] | planes[1] | planes[2] | planes[3]) & ~this->mines[y] & ROW_MASK;
+        }
+
+        for (auto y: std::views::iota(0, Height))
+            for (auto x: std::views::iota(0, Width))
+                this->layout[x + y * Width] = static_cast<uint8_t>(this->getMineCount(x, y)) |
+                                              (this->isMine(x, y) ? TILE_MINE_BIT : 0);
+    }
+
+    // Grows region through its empty tiles into tiles where isOpen(y) is set,
+    //   until nothing more is reachable. A row only needs growing again after
+    //   a row next to it grew, so the fill works through a mask of dirty rows.
+    //   Returns the first and last rows the fill touched.
+    template<typename OpenFn>
+    static std::pair<int32_t, int32_t> fill(Rows& region, Rows const& empty, OpenFn&& isOpen, int32_t seedY)
+    {
+        auto top    = seedY;
+        auto bottom = seedY;
+
+        uint64_t dirty = (bit(seedY) | bit(seedY) << 1 | bit(seedY) >> 1) & ((uint64_t {2} << (Height - 1)) - 1);
+        while (dirty)
+        {
+            auto y = std::countr_zero(dirty);
+            dirty &= dirty - 1;
+
+            auto open  = isOpen(y);
+            auto above = getRow(region, y - 1) & getRow(empty, y - 1);
+            auto below = getRow(region, y + 1) & getRow(empty, y + 1);
+            auto row   = region[y] | (spreadRow(above | below) & open);
+            // Runs of empty tiles within the row fill in a few steps
+            for (Row previous = 0; row != previous;)
+            {
+                previous = row;
+                row |= spreadRow(row & empty[y]) & open;
+            }
+            if (row == region[y])
+                continue;
+
+            region[y] = row;
+            top       = std::min(top, y);
+            bottom    = std::max(bottom, y);
+            if (y > 0)
+                dirty |= bit(y - 1);
+            if (y + 1 < Height)
+                dirty |= bit(y + 1);
+        }
+
+        return {top, bottom};
+    }
+
+    void uncoverTile(int32_t x, int32_t y)
+    {
+        if (this->uncovered[y] & bit(x))
+            return;
+
+        this->uncovered[y] |= bit(x);
+        if (this->mines[y] & bit(x))
+            this->mineDetonated = true;
+        else
+            this->numCoveredSafe--;
+    }
+
+    // Uncovers the tile, and the whole opening around it if it is empty
+    void uncoverFrom(int32_t x, int32_t y)
+    {
+        this->uncoverTile(x, y);
+        if (!(this->empty[y] & bit(x)))
+            return;
+
+        Rows region {};
+        region[y] = bit(x);
+
+        auto [top, bottom] = fill(
+            region, this->empty, [this](int32_t row) { return ~this->uncovered[row] & ~this->flagged[row] & ROW_MASK; },
+            y);
+        for (auto row: std::views::iota(top, bottom + 1))
+        {
+            // Mines are never next to an empty tile, so the fill only reaches
+            //   safe ones
+            this->numCoveredSafe -= std::popcount(region[row] & ~this->uncovered[row]);
+            this->uncovered[row] |= region[row];
+        }
+    }
+
+    // Every opening is one click, and so is every number not touching one.
+    //   Openings are counted as runs of empty tiles, less one for every pair
+    //   of runs on neighbouring rows that join two openings together.
+    void computeBoardValue()
+    {
+        constexpr int32_t MAX_RUNS {Height * ((Width + 1) / 2)};
+
+        std::array<int16_t, MAX_RUNS> parent;
+        std::array<Row, MAX_RUNS> runs;
+        auto findRoot = [&parent](int16_t run)
+        {
+            while (parent[run] != run)
+            {
+                parent[run] = parent[parent[run]];
+                run         = parent[run];
+            }
+            return run;
+        };
+
+        int32_t boardValue = 0;
+        int16_t numRuns    = 0;
+        int16_t prevFirst  = 0;
+        for (auto y: std::views::iota(0, Height))
+        {
+            auto first = numRuns;
+            for (auto bits = this->empty[y]; bits;)
+            {
+                // Adding the lowest bit carries through the whole run
+                auto low  = bits & -bits;
+                auto run  = bits & ~(bits + low);
+                bits     &= ~run;
+
+                parent[numRuns] = numRuns;
+                runs[numRuns]   = run;
+                boardValue++;
+                for (auto above: std::views::iota(prevFirst, first))
+                {
+                    if (!(spreadRow(run) & runs[above]))
+                        continue;
+                    auto root      = findRoot(numRuns);
+                    auto aboveRoot = findRoot(above);
+                    if (root == aboveRoot)
+                        continue;
+                    parent[std::max(root, aboveRoot)] = std::min(root, aboveRoot);
+                    boardValue--;
+                }
+                numRuns++;
+            }
+            prevFirst = first;
+        }
+
+        auto bordered = dilate(this->empty);
+        for (auto y: std::views::iota(0, Height))
+            boardValue += std::popcount(~this->mines[y] & ~this->empty[y] & ~bordered[y] & ROW_MASK);
+
+        this->stats.boardValue = boardValue;
+    }
+
+    void placeMines()
+    {
+        // Each draw is split into two 32 bit halves, and each half is scaled
+        //   onto the board with a multiply instead of a division. The bias
+        //   this leaves is far below anything a game could notice.
+        auto toTile = [](uint64_t half) { return static_cast<int32_t>((half * (Width * Height)) >> 32); };
+
+        this->mines = {};
+        for (int32_t placed = 0; placed < Mines;)
+        {
+            auto draw = this->rng();
+            for (auto tile: {toTile(draw & 0xFFFFFFFF), toTile(draw >> 32)})
+            {
+                auto& row = this->mines[tile / Width];
+                if (placed == Mines or row & bit(tile % Width))
+                    continue;
+                row |= bit(tile % Width);
+                placed++;
+            }
+        }
+    }
+
+    // Packed the same way as a GameBoard tile, without the telegraph bit
+    uint8_t packTile(int32_t x, int32_t y) const
+    {
+        return this->layout[x + y * Width] | packTileState(this->getTileState(x, y));
+    }
+
+    bool checkWinCon() const
+    {
+        return this->numCoveredSafe == 0;
+    }
+
+    bool checkLoseCon() const
+    {
+        return this->mineDetonated;
+    }
+
+public:
+    static constexpr int32_t BOARD_WIDTH {Width};
+    static constexpr int32_t BOARD_HEIGHT {Height};
+    static constexpr int32_t MINE_COUNT {Mines};
+
+    BitBoard()
+    {
+        this->initialize();
+    }
+
+    void initialize()
+    {
+        this->uncovered      = {};
+        this->flagged        = {};
+        this->telegraphed    = {};
+        this->numCoveredSafe = Width * Height - Mines;
+        this->mineDetonated  = false;
+        this->shownUncovered = {};
+        this->shownFlagged   = {};
+        this->shownLost      = false;
+        this->gameState    = GameState::GAME_NOT_STARTED;
+        this->clockStarted = false;
+        this->numFlags     = 0;
+        this->lastClickedX = -1;
+        this->lastClickedY = -1;
+
+        this->placeMines();
+        this->countNeighbours();
+        this->stats = GameStats {};
+        this->computeBoardValue();
+    }
+
+    inline auto getGameState() const
+    {
+        return this->gameState;
+    }
+
+    inline auto const& getStats() const
+    {
+        return this->stats;
+    }
+
+    inline auto getFinishTime() const
+    {
+        return this->finishTime;
+    }
+
+    inline auto getTopology() const
+    {
+        return Topology::SQUARE;
+    }
+
+    inline auto getBoardConfig() const
+    {
+        return std::make_tuple(Width, Height, Mines);
+    }
+
+    // Openings are filled in one go, so there is never a reveal to step
+    inline bool isRevealing() const
+    {
+        return false;
+    }
+
+    inline bool advanceReveal(int64_t)
+    {
+        return false;
+    }
+
+    inline bool isMine(int32_t x, int32_t y) const
+    {
+        return this->mines[y] & bit(x);
+    }
+
+    inline int32_t getMineCount(int32_t x, int32_t y) const
+    {
+        int32_t count = 0;
+        for (auto i: std::views::iota(0, 4))
+            count |= static_cast<int32_t>(this->countPlanes[i][y] >> x & 1) << i;
+
+        return count;
+    }
+
+    inline TileState getTileState(int32_t x, int32_t y) const
+    {
+        if (this->uncovered[y] & bit(x))
+            return TileState::UNCOVERED;
+        if (this->flagged[y] & bit(x))
+            return TileState::FLAGGED;
+
+        return TileState::COVERED;
+    }
+
+    void interact(int32_t x, int32_t y, sf::Mouse::Button mouseBtn)
+    {
+        if (mouseBtn != sf::Mouse::Button::Left and mouseBtn != sf::Mouse::Button::Right)
+            return;
+        if (x < 0 or x >= Width or y < 0 or y >= Height)
+            return;
+
+        this->lastClickedX = x;
+        this->lastClickedY = y;
+        this->stats.clicks++;
+        switch (this->getTileState(x, y))
+        {
+        case TileState::COVERED:
+            if (!this->clockStarted)
+            {
+                this->gameClock.restart();
+                this->clockStarted = true;
+            }
+
+            if (mouseBtn == sf::Mouse::Button::Left)
+            {
+                // Losing on first turn is not allowed -- the mine moves to the
+                //   first free tile, same as on GameBoard
+                if (this->gameState == GameState::GAME_NOT_STARTED and this->isMine(x, y))
+                {
+                    this->mines[y] &= ~bit(x);
+                    for (auto row: std::views::iota(0, Height))
+                    {
+                        auto free = ~this->mines[row] & ROW_MASK & (row == y ? ~bit(x) : ~Row {0});
+                        if (free)
+                        {
+                            this->mines[row] |= free & -free;
+                            break;
+                        }
+                    }
+                    this->countNeighbours();
+                    this->computeBoardValue();
+                }
+                this->uncoverTile(x, y);
+                this->gameState = GameState::GAME_ONGOING;
+            }
+            else
+            {
+                this->flagged[y] |= bit(x);
+                this->numFlags++;
+            }
+            break;
+        case TileState::UNCOVERED:
+        {
+            if (mouseBtn != sf::Mouse::Button::Left)
+                return;
+
+            Rows around {};
+            around[y] = bit(x);
+            around    = dilate(around);
+            around[y] &= ~bit(x);
+
+            int32_t flags = 0;
+            for (auto row: std::views::iota(std::max(y - 1, 0), std::min(y + 2, Height)))
+                flags += std::popcount(around[row] & this->flagged[row]);
+            if (this->getMineCount(x, y) != flags)
+                return;
+
+            Rows revealed {};
+            bool anyRevealed = false;
+            for (auto row: std::views::iota(std::max(y - 1, 0), std::min(y + 2, Height)))
+            {
+                revealed[row] = around[row] & ~this->uncovered[row] & ~this->flagged[row];
+                anyRevealed |= revealed[row] != 0;
+            }
+            if (!anyRevealed)
+                return;
+
+            for (auto row: std::views::iota(std::max(y - 1, 0), std::min(y + 2, Height)))
+                for (auto bits = revealed[row]; bits; bits &= bits - 1)
+                    this->uncoverFrom(std::countr_zero(bits), row);
+            break;
+        }
+        case TileState::FLAGGED:
+            if (mouseBtn == sf::Mouse::Button::Left)
+                return;
+
+            this->flagged[y] &= ~bit(x);
+            this->numFlags--;
+            break;
+        }
+
+        this->stats.effectiveClicks++;
+        if (this->uncovered[y] & this->empty[y] & bit(x))
+            this->uncoverFrom(x, y);
+
+        if (this->checkLoseCon())
+        {
+            this->gameState  = GameState::GAME_LOST;
+            this->finishTime = this->gameClock.getElapsedTime();
+        }
+        else if (this->checkWinCon())
+        {
+            this->gameState  = GameState::GAME_WON;
+            this->finishTime = this->gameClock.getElapsedTime();
+        }
+    }
+
+    // Takes a position on the board in tiles, as GameBoard does
+    void interact(float x, float y, sf::Mouse::Button mouseBtn)
+    {
+        if (x < 0 or y < 0)
+            return;
+
+        this->interact(static_cast<int32_t>(x), static_cast<int32_t>(y), mouseBtn);
+    }
+
+    // Presses the tile under the cursor, or the covered tiles around it if it
+    //   is a number
+    void telegraph(float x, float y)
+    {
+        this->clearTelegraph();
+        if (x < 0 or x >= Width or y < 0 or y >= Height)
+            return;
+
+        auto tileX = static_cast<int32_t>(x);
+        auto tileY = static_cast<int32_t>(y);
+        switch (this->getTileState(tileX, tileY))
+        {
+        case TileState::COVERED:
+            this->telegraphed[tileY] = bit(tileX);
+            break;
+        case TileState::UNCOVERED:
+        {
+            Rows around {};
+            around[tileY] = bit(tileX);
+            around        = dilate(around);
+            for (auto row: std::views::iota(std::max(tileY - 1, 0), std::min(tileY + 2, Height)))
+                this->telegraphed[row] = around[row] & ~this->uncovered[row] & ~this->flagged[row];
+            break;
+        }
+        case TileState::FLAGGED:
+            break;
+        }
+    }
+
+    void clearTelegraph()
+    {
+        this->telegraphed = {};
+    }
+
+    // Changes are only recorded while this is on. Starting a game discards
+    //   any that were not taken.
+    void setRecordingChanges(bool recording)
+    {
+        this->recordingChanges = recording;
+        this->shownUncovered   = this->uncovered;
+        this->shownFlagged     = this->flagged;
+        this->shownLost        = this->gameState == GameState::GAME_LOST;
+    }
+
+    // Same as GameBoard::takeDelta. The changed tiles are whatever differs
+    //   from the last delta, plus every covered mine and every flag once the
+    //   game is lost.
+    bool takeDelta(BoardDelta& delta)
+    {
+        delta.boardWidth  = Width;
+        delta.boardHeight = Height;
+        delta.mineCount   = Mines;
+        delta.topology    = Topology::SQUARE;
+        delta.gameState   = this->gameState;
+        delta.lastClicked = this->lastClickedX >= 0 ? this->lastClickedX + this->lastClickedY * Width : -1;
+        delta.runs.clear();
+        delta.tiles.clear();
+        if (!this->recordingChanges)
+            return false;
+
+        auto lost = this->gameState == GameState::GAME_LOST;
+        for (auto y: std::views::iota(0, Height))
+        {
+            auto changed = (this->uncovered[y] ^ this->shownUncovered[y]) | (this->flagged[y] ^ this->shownFlagged[y]);
+            if (lost and !this->shownLost)
+                changed |= (this->mines[y] | this->flagged[y]) & ~this->uncovered[y];
+            auto hidden = lost ? Row {0} : ~this->uncovered[y];
+
+            for (; changed; changed &= changed - 1)
+            {
+                auto x    = std::countr_zero(changed);
+                auto tile = x + static_cast<int64_t>(y) * Width;
+                if (!delta.runs.empty() and delta.runs.back().first + delta.runs.back().length == tile)
+                    delta.runs.back().length++;
+                else
+                    delta.runs.push_back({tile, 1});
+                auto value = this->packTile(x, y);
+                if (hidden & bit(x))
+                    value &= TILE_STATE_MASK;
+                delta.tiles.push_back(value);
+            }
+        }
+
+        this->shownUncovered = this->uncovered;
+        this->shownFlagged   = this->flagged;
+        this->shownLost      = lost;
+        return !delta.runs.empty();
+    }
+
+    // Same as GameBoard::getEndgamePosition, working from the covered rows.
+    //   A tile's place in a list of tiles in board order is the number of
+    //   tiles before it, so no list of covered tiles is ever built.
+    bool getEndgamePosition(EndgamePosition& position) const
+    {
+        if (this->gameState != GameState::GAME_ONGOING or this->numCoveredSafe > MAX_ENDGAME_TILES)
+            return false;
+
+        Rows covered;
+        for (auto y: std::views::iota(0, Height))
+            covered[y] = ~this->uncovered[y] & ROW_MASK;
+
+        // A number gives its mines away once it has as many covered tiles
+        //   around it as it has mines. That does not depend on which other
+        //   mines are known, so every such number is found in one pass over
+        //   the rows, comparing the covered counts with the mine counts.
+        Rows numbers;
+        Rows settled;
+        auto bordering = dilate(covered);
+        for (auto y: std::views::iota(0, Height))
+        {
+            numbers[y]       = bordering[y] & this->uncovered[y];
+            auto coveredSums = sumNeighbours(covered, y);
+            Row differs      = 0;
+            for (auto i: std::views::iota(0, 4))
+                differs |= coveredSums[i] ^ this->countPlanes[i][y];
+            settled[y] = numbers[y] & ~differs;
+        }
+
+        auto settledAround = dilate(settled);
+        Rows knownMines;
+        Rows open;
+        std::array<int32_t, Height> firstOpen;
+        int32_t numOpen  = 0;
+        int32_t numKnown = 0;
+        for (auto y: std::views::iota(0, Height))
+        {
+            knownMines[y] = covered[y] & settledAround[y];
+            open[y]       = covered[y] & ~knownMines[y];
+            firstOpen[y]  = numOpen;
+            numOpen += std::popcount(open[y]);
+            numKnown += std::popcount(knownMines[y]);
+        }
+        if (numOpen > MAX_ENDGAME_TILES)
+            return false;
+
+        // Tiles of rows around the tile at x, y
+        auto around = [](Rows const& rows, int32_t x, int32_t y, int32_t ny)
+        { return getRow(rows, ny) & spreadRow(bit(x)) & ~(ny == y ? bit(x) : 0); };
+
+        // The position's bits for the open tiles around the tile at x, y
+        auto openAround = [&](int32_t x, int32_t y)
+        {
+            uint64_t result = 0;
+            for (auto ny: std::views::iota(std::max(y - 1, 0), std::min(y + 2, Height)))
+                for (auto bits = around(open, x, y, ny); bits; bits &= bits - 1)
+                    result |= uint64_t {1}
+                              << (firstOpen[ny] + std::popcount(open[ny] & (bit(std::countr_zero(bits)) - 1)));
+            return result;
+        };
+
+        position.minesLeft = Mines - numKnown;
+        position.tiles.clear();
+        position.constraints.clear();
+        for (auto y: std::views::iota(0, Height))
+        {
+            for (auto bits = open[y]; bits; bits &= bits - 1)
+            {
+                auto x = std::countr_zero(bits);
+                position.tiles.push_back({x, y, openAround(x, y)});
+            }
+        }
+
+        // Only numbers next to an open tile say anything the solver needs
+        auto openBordering = dilate(open);
+        for (auto y: std::views::iota(0, Height))
+        {
+            for (auto bits = numbers[y] & openBordering[y]; bits; bits &= bits - 1)
+            {
+                auto x     = std::countr_zero(bits);
+                auto known = 0;
+                for (auto ny: std::views::iota(y - 1, y + 2))
+                    known += std::popcount(around(knownMines, x, y, ny));
+                position.constraints.push_back({openAround(x, y), this->getMineCount(x, y) - known});
+            }
+        }
+
+        return true;
+    }
+
+    // Packs the board into the same snapshot format GameBoard publishes, so
+    //   BoardView can draw it. Boards this small always fit in the region, so
+    //   the origin is only there to match GameBoard.
+    void publish(BoardSnapshot& snapshot, int32_t = 0, int32_t = 0) const
+    {
+        snapshot.boardWidth   = Width;
+        snapshot.boardHeight  = Height;
+        snapshot.mineCount    = Mines;
+        snapshot.topology     = Topology::SQUARE;
+        snapshot.gameState    = this->gameState;
+        snapshot.clockStarted = this->clockStarted;
+        snapshot.gameClock    = this->gameClock;
+        snapshot.finishTime   = this->finishTime;
+        snapshot.numFlags     = this->numFlags;
+        snapshot.stats        = this->stats;
+        snapshot.lastClickedX = this->lastClickedX;
+        snapshot.lastClickedY = this->lastClickedY;
+        snapshot.regionX      = 0;
+        snapshot.regionY      = 0;
+        snapshot.regionWidth  = Width;
+        snapshot.regionHeight = Height;
+        snapshot.tiles.resize(Width * Height);
+
+        // Eight tiles at a time: each state row is spread out to one bit per
+        //   byte and shifted straight into place
+        static_assert(packTileState(TileState::UNCOVERED) == 1 << 5 and packTileState(TileState::FLAGGED) == 1 << 6);
+        static_assert(TILE_TELEGRAPH_BIT == 1 << 7);
+        static_assert(std::endian::native == std::endian::little);
+        auto packEight = [this]<size_t NumBytes>(uint8_t* out, uint8_t const* in, int32_t x, int32_t y)
+        {
+            uint64_t word = 0;
+            std::memcpy(&word, in + x, NumBytes);
+            word |= SPREAD_BITS[this->uncovered[y] >> x & 0xFF] << 5 |
+                    SPREAD_BITS[this->flagged[y] >> x & 0xFF] << 6 |
+                    SPREAD_BITS[this->telegraphed[y] >> x & 0xFF] << 7;
+            std::memcpy(out + x, &word, NumBytes);
+        };
+        // The copy sizes are known at compile time, so each copy is a single
+        //   load or store rather than a call
+        constexpr int32_t FULL_BYTES {Width / 8 * 8};
+        for (auto y: std::views::iota(0, Height))
+        {
+            auto* out      = snapshot.tiles.data() + y * Width;
+            auto const* in = this->layout.data() + y * Width;
+            for (int32_t x = 0; x < FULL_BYTES; x += 8)
+                packEight.template operator()<8>(out, in, x, y);
+            if constexpr (Width % 8 != 0)
+                packEight.template operator()<Width % 8>(out, in, FULL_BYTES, y);
+        }
+    }
+};
+
+using BeginnerBoard     = BitBoard<9, 9, 10>;
+using IntermediateBoard = BitBoard<16, 16, 40>;
+using ExpertBoard       = BitBoard<30, 16, 99>;
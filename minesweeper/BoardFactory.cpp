@@ -0,0 +1,95 @@
+#include "BoardFactory.h"
+
+#include "Trace.h"
+
+BoardFactory::BoardFactory()
+{
+    this->thread = std::thread {&BoardFactory::run, this};
+}
+
+BoardFactory::~BoardFactory()
+{
+    {
+        std::lock_guard lock {this->mutex};
+        this->stop = true;
+    }
+    this->condition.notify_all();
+    this->thread.join();
+}
+
+void BoardFactory::request(int32_t boardWidth, int32_t boardHeight, int32_t mineCount, Topology topology)
+{
+    Config config {boardWidth, boardHeight, mineCount, topology};
+    // Boards big enough to be paged to disk are not built ahead, since a
+    //   second one would double the scratch file and fight the first for I/O
+    auto paged = static_cast<int64_t>(boardWidth + 2) * (boardHeight + 2) > MAX_RESIDENT_TILE_BYTES;
+
+    std::unique_ptr<GameBoard> discarded;
+    {
+        std::lock_guard lock {this->mutex};
+        if (this->wanted != config)
+            discarded = std::move(this->ready);
+
+        if (paged)
+            this->wanted.reset();
+        else
+            this->wanted = config;
+    }
+    this->condition.notify_all();
+}
+
+std::unique_ptr<GameBoard> BoardFactory::take(int32_t boardWidth, int32_t boardHeight, int32_t mineCount,
+                                              Topology topology)
+{
+    Config config {boardWidth, boardHeight, mineCount, topology};
+    std::unique_ptr<GameBoard> board;
+    {
+        std::lock_guard lock {this->mutex};
+        if (this->wanted == config)
+            board = std::move(this->ready);
+    }
+    this->condition.notify_all();
+
+    return board;
+}
+
+void BoardFactory::clear()
+{
+    std::unique_ptr<GameBoard> discarded;
+    {
+        std::lock_guard lock {this->mutex};
+        discarded = std::move(this->ready);
+        this->wanted.reset();
+    }
+    this->condition.notify_all();
+}
+
+void BoardFactory::run()
+{
+    Tracer::setThreadName("Board factory");
+    std::unique_lock lock {this->mutex};
+    while (true)
+    {
+        this->condition.wait(lock, [this] { return this->stop or (this->wanted and !this->ready); });
+        if (this->stop)
+            return;
+
+        auto config = *this->wanted;
+        lock.unlock();
+
+        TRACE_SCOPE("BoardFactory::build");
+        auto board = std::make_unique<GameBoard>(config.boardWidth, config.boardHeight, config.mineCount,
+                                                 config.topology);
+
+        lock.lock();
+        // The config may have changed while this one was being built
+        if (this->wanted == config)
+            this->ready = std::move(board);
+        else
+        {
+            lock.unlock();
+            board.reset();
+            lock.lock();
+        }
+    }
+}
@@ -0,0 +1,54 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <thread>
+
+#include "Minesweeper.h"
+
+// Builds the next board on a worker thread while the current one is being
+//   played, so starting another game only has to swap it in. Holds at most
+//   one finished board, for the config last requested.
+class BoardFactory
+{
+private:
+    struct Config
+    {
+        int32_t boardWidth;
+        int32_t boardHeight;
+        int32_t mineCount;
+        Topology topology;
+
+        bool operator==(Config const&) const = default;
+    };
+
+    std::mutex mutex;
+    std::condition_variable condition;
+    std::thread thread;
+    bool stop {false};
+
+    std::optional<Config> wanted;
+    std::unique_ptr<GameBoard> ready;
+
+    void run();
+
+public:
+    BoardFactory();
+    BoardFactory(BoardFactory const&) = delete;
+    void operator=(BoardFactory const&) = delete;
+    ~BoardFactory();
+
+    // Starts building a board for this config unless one is already built or
+    //   underway. A board built for any other config is thrown away.
+    void request(int32_t boardWidth, int32_t boardHeight, int32_t mineCount, Topology topology);
+
+    // Hands over the finished board if it was built for this config, and
+    //   starts on the one after it. Returns null if there is none yet.
+    std::unique_ptr<GameBoard> take(int32_t boardWidth, int32_t boardHeight, int32_t mineCount, Topology topology);
+
+    // Stops building ahead and throws away any board already built
+    void clear();
+};
@@ -0,0 +1,112 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <optional>
+#include <random>
+#include <ranges>
+
+#include <SFML/Graphics.hpp>
+
+#include "Minesweeper.h"
+
+struct BotMove
+{
+    int32_t x;
+    int32_t y;
+    sf::Mouse::Button button;
+};
+
+// Picks the bot's next move on a BitBoard. Opens the middle tile to start,
+//   then opens or flags around any number that settles all of its neighbours,
+//   and guesses when none does. Empty only if the game is over or every
+//   covered tile is flagged.
+template<typename Board, typename Rng>
+std::optional<BotMove> chooseBotMove(Board const& board, Rng& rng)
+{
+    constexpr auto WIDTH  = Board::BOARD_WIDTH;
+    constexpr auto HEIGHT = Board::BOARD_HEIGHT;
+    constexpr auto TILES  = WIDTH * HEIGHT;
+
+    switch (board.getGameState())
+    {
+    case GameState::GAME_WON:
+    case GameState::GAME_LOST:
+        return std::nullopt;
+    case GameState::GAME_NOT_STARTED:
+        return BotMove {WIDTH / 2, HEIGHT / 2, sf::Mouse::Button::Left};
+    case GameState::GAME_ONGOING:
+        break;
+    }
+
+    // Look for a number whose mines are all flagged, so the rest can be
+    //   opened, or one whose covered neighbours must all be mines
+    for (auto y: std::views::iota(0, HEIGHT))
+    {
+        for (auto x: std::views::iota(0, WIDTH))
+        {
+            if (board.getTileState(x, y) != TileState::UNCOVERED or board.getMineCount(x, y) == 0)
+                continue;
+
+            int32_t numCovered = 0;
+            int32_t numFlagged = 0;
+            int32_t coveredX   = 0;
+            int32_t coveredY   = 0;
+            for (auto ny: std::views::iota(std::max(y - 1, 0), std::min(y + 2, HEIGHT)))
+            {
+                for (auto nx: std::views::iota(std::max(x - 1, 0), std::min(x + 2, WIDTH)))
+                {
+                    switch (board.getTileState(nx, ny))
+                    {
+                    case TileState::COVERED:
+                        numCovered++;
+                        coveredX = nx;
+                        coveredY = ny;
+                        break;
+                    case TileState::FLAGGED:
+                        numFlagged++;
+                        break;
+                    case TileState::UNCOVERED:
+                        break;
+                    }
+                }
+            }
+
+            if (numCovered == 0)
+                continue;
+            if (numFlagged == board.getMineCount(x, y))
+                return BotMove {coveredX, coveredY, sf::Mouse::Button::Left};
+            if (numFlagged + numCovered == board.getMineCount(x, y))
+                return BotMove {coveredX, coveredY, sf::Mouse::Button::Right};
+        }
+    }
+
+    // Nothing certain, so guess
+    std::uniform_int_distribution<int32_t> pick {0, TILES - 1};
+    for (auto attempt = 0; attempt < TILES; attempt++)
+    {
+        auto tile = pick(rng);
+        if (board.getTileState(tile % WIDTH, tile / WIDTH) == TileState::COVERED)
+            return BotMove {tile % WIDTH, tile / WIDTH, sf::Mouse::Button::Left};
+    }
+
+    // Late in a game few covered tiles are left for random picks to land on,
+    //   so take the first one rather than leave the game unfinished
+    for (auto tile: std::views::iota(0, TILES))
+        if (board.getTileState(tile % WIDTH, tile / WIDTH) == TileState::COVERED)
+            return BotMove {tile % WIDTH, tile / WIDTH, sf::Mouse::Button::Left};
+
+    return std::nullopt;
+}
+
+// Plays the bot's next move. Returns false if it had none.
+template<typename Board, typename Rng>
+bool playBotMove(Board& board, Rng& rng)
+{
+    auto move = chooseBotMove(board, rng);
+    if (!move)
+        return false;
+
+    board.interact(move->x, move->y, move->button);
+    return true;
+}
@@ -0,0 +1,326 @@
+#include "Dataset.h"
+
+#include "Trace.h"
+
+#include <algorithm>
+#include <iostream>
+#include <ranges>
+#include <string_view>
+
+static void putInteger(std::vector<uint8_t>& out, uint64_t value, int32_t numBytes)
+{
+    for (auto i: std::views::iota(0, numBytes))
+        out.push_back(static_cast<uint8_t>(value >> (8 * i)));
+}
+
+static void putVarint(std::vector<uint8_t>& out, uint64_t value)
+{
+    while (value >= 0x80)
+    {
+        out.push_back(static_cast<uint8_t>(value | 0x80));
+        value >>= 7;
+    }
+    out.push_back(static_cast<uint8_t>(value));
+}
+
+static bool getInteger(std::istream& in, uint64_t& value, int32_t numBytes)
+{
+    uint8_t bytes[8];
+    if (!in.read(reinterpret_cast<char*>(bytes), numBytes))
+        return false;
+
+    value = 0;
+    for (auto i: std::views::iota(0, numBytes))
+        value |= static_cast<uint64_t>(bytes[i]) << (8 * i);
+    return true;
+}
+
+static bool getVarint(std::vector<uint8_t> const& in, size_t& at, uint64_t& value)
+{
+    value = 0;
+    for (int32_t shift = 0; at < in.size() and shift < 64; shift += 7)
+    {
+        auto byte = in[at++];
+        value |= static_cast<uint64_t>(byte & 0x7f) << shift;
+        if (!(byte & 0x80))
+            return true;
+    }
+    return false;
+}
+
+static void encodeColumn(std::vector<uint8_t>& column, size_t recordBytes, std::vector<uint8_t>& out)
+{
+    // Back to front, so every record is still intact when the one after it
+    //   is xored with it
+    for (auto i = column.size(); i-- > recordBytes;)
+        column[i] ^= column[i - recordBytes];
+
+    auto sizeAt = out.size();
+    putInteger(out, 0, 4);
+
+    size_t i = 0;
+    while (i < column.size())
+    {
+        auto zerosStart = i;
+        while (i < column.size() and column[i] == 0)
+            i++;
+        auto literalStart = i;
+        // A literal run ends at the first pair of zeros, since a lone zero
+        //   costs less kept in the run than starting a new one
+        while (i < column.size() and !(column[i] == 0 and (i + 1 == column.size() or column[i + 1] == 0)))
+            i++;
+
+        putVarint(out, literalStart - zerosStart);
+        putVarint(out, i - literalStart);
+        out.insert(out.end(), column.begin() + literalStart, column.begin() + i);
+    }
+
+    auto size = out.size() - sizeAt - 4;
+    for (auto b: std::views::iota(0, 4))
+        out[sizeAt + b] = static_cast<uint8_t>(size >> (8 * b));
+}
+
+// The most bytes encodeColumn can turn a column into. Every run takes at
+//   least one byte of the column, and its two varints are no longer than the
+//   column's size needs.
+static uint64_t maxEncodedSize(uint64_t columnSize)
+{
+    uint64_t varintBytes = 1;
+    for (auto value = columnSize; value >= 0x80; value >>= 7)
+        varintBytes++;
+    return columnSize + columnSize * 2 * varintBytes;
+}
+
+// Undoes encodeColumn, checking the runs fill exactly numRecords records.
+//   The size is checked against the column and the rest of the file before
+//   anything is allocated for it.
+static bool decodeColumn(std::istream& in, uint64_t fileSize, size_t recordBytes, size_t numRecords,
+                         std::vector<uint8_t>& column)
+{
+    uint64_t size = 0;
+    if (!getInteger(in, size, 4))
+        return false;
+    auto position = static_cast<int64_t>(in.tellg());
+    if (position < 0 or size > fileSize - static_cast<uint64_t>(position) or
+        size > maxEncodedSize(recordBytes * numRecords))
+        return false;
+    std::vector<uint8_t> encoded(size);
+    if (!in.read(reinterpret_cast<char*>(encoded.data()), static_cast<std::streamsize>(size)))
+        return false;
+
+    column.assign(recordBytes * numRecords, 0);
+    size_t at = 0;
+    size_t i  = 0;
+    while (at < encoded.size())
+    {
+        uint64_t zeros    = 0;
+        uint64_t literals = 0;
+        if (!getVarint(encoded, at, zeros) or !getVarint(encoded, at, literals))
+            return false;
+        if (zeros > column.size() - i or literals > column.size() - i - zeros or literals > encoded.size() - at)
+            return false;
+
+        i += zeros;
+        std::copy_n(encoded.begin() + at, literals, column.begin() + i);
+        at += literals;
+        i  += literals;
+    }
+    if (i != column.size())
+        return false;
+
+    // Front to back, so every record is restored before the one after it is
+    //   xored with it
+    for (auto j = recordBytes; j < column.size(); j++)
+        column[j] ^= column[j - recordBytes];
+    return true;
+}
+
+DatasetChunk::DatasetChunk(int32_t numTiles): numTiles(numTiles)
+{
+    this->games.reserve(CAPACITY * 4);
+    this->moves.reserve(CAPACITY * 3);
+    this->tiles.reserve(static_cast<size_t>(CAPACITY) * ((numTiles + 1) / 2));
+    this->mines.reserve(static_cast<size_t>(CAPACITY) * ((numTiles + 7) / 8));
+    this->solver.reserve(CAPACITY * 5);
+}
+
+std::vector<uint8_t> DatasetChunk::encode()
+{
+    TRACE_SCOPE("DatasetChunk::encode");
+    std::vector<uint8_t> out;
+    putInteger(out, this->numRecords, 4);
+    encodeColumn(this->games, 4, out);
+    encodeColumn(this->moves, 3, out);
+    encodeColumn(this->tiles, (this->numTiles + 1) / 2, out);
+    encodeColumn(this->mines, (this->numTiles + 7) / 8, out);
+    encodeColumn(this->solver, 5, out);
+
+    this->numRecords = 0;
+    this->games.clear();
+    this->moves.clear();
+    this->tiles.clear();
+    this->mines.clear();
+    this->solver.clear();
+    return out;
+}
+
+DatasetWriter::DatasetWriter(std::filesystem::path const& path, int32_t boardWidth, int32_t boardHeight,
+                             int32_t mineCount):
+    file(path, std::ios::binary | std::ios::trunc)
+{
+    std::vector<uint8_t> header {'M', 'S', 'D', 'S'};
+    putInteger(header, VERSION, 4);
+    putInteger(header, boardWidth, 2);
+    putInteger(header, boardHeight, 2);
+    putInteger(header, mineCount, 2);
+    this->file.write(reinterpret_cast<char const*>(header.data()), static_cast<std::streamsize>(header.size()));
+    if (this->file.is_open())
+        this->checkWrite();
+    else
+        this->writeFailed.store(true, std::memory_order_relaxed);
+
+    this->thread = std::thread {&DatasetWriter::run, this};
+}
+
+DatasetWriter::~DatasetWriter()
+{
+    this->finish();
+}
+
+void DatasetWriter::finish()
+{
+    if (!this->thread.joinable())
+        return;
+
+    {
+        std::lock_guard lock {this->mutex};
+        this->stop = true;
+    }
+    this->condition.notify_all();
+    this->thread.join();
+}
+
+void DatasetWriter::checkWrite()
+{
+    if (this->file or this->writeFailed.exchange(true, std::memory_order_relaxed))
+        return;
+    std::cerr << "Could not write the dataset, later records are dropped" << std::endl;
+}
+
+void DatasetWriter::push(std::vector<uint8_t> chunk)
+{
+    if (this->failed())
+        return;
+
+    {
+        std::unique_lock lock {this->mutex};
+        this->condition.wait(lock, [this] { return this->queue.size() < MAX_QUEUED; });
+        this->queue.push_back(std::move(chunk));
+    }
+    this->condition.notify_all();
+}
+
+void DatasetWriter::run()
+{
+    Tracer::setThreadName("Dataset writer");
+    std::unique_lock lock {this->mutex};
+    while (true)
+    {
+        this->condition.wait(lock, [this] { return this->stop or !this->queue.empty(); });
+        if (this->queue.empty())
+        {
+            this->file.flush();
+            this->checkWrite();
+            return;
+        }
+
+        auto chunk = std::move(this->queue.front());
+        this->queue.pop_front();
+        lock.unlock();
+        this->condition.notify_all();
+
+        if (!this->failed())
+        {
+            TRACE_SCOPE("DatasetWriter::write");
+            this->file.write(reinterpret_cast<char const*>(chunk.data()), static_cast<std::streamsize>(chunk.size()));
+            this->checkWrite();
+        }
+        lock.lock();
+    }
+}
+
+DatasetReader::DatasetReader(std::filesystem::path const& path): file(path, std::ios::binary)
+{
+    char magic[4];
+    uint64_t version = 0;
+    uint64_t width   = 0;
+    uint64_t height  = 0;
+    uint64_t mines   = 0;
+    this->valid = this->file.read(magic, 4) and std::string_view {magic, 4} == "MSDS" and
+                  getInteger(this->file, version, 4) and version == DatasetWriter::VERSION and
+                  getInteger(this->file, width, 2) and getInteger(this->file, height, 2) and
+                  getInteger(this->file, mines, 2);
+    // Tile numbers are stored in 16 bits, with 0xffff kept for no tile, which
+    //   also bounds the columns a chunk can claim
+    this->valid = this->valid and width * height <= DatasetChunk::NO_BEST_TILE;
+
+    std::error_code error;
+    this->fileSize = std::filesystem::file_size(path, error);
+    this->valid    = this->valid and !error;
+
+    this->boardWidth  = static_cast<int32_t>(width);
+    this->boardHeight = static_cast<int32_t>(height);
+    this->mineCount   = static_cast<int32_t>(mines);
+}
+
+bool DatasetReader::read(std::vector<DatasetRecord>& records)
+{
+    TRACE_SCOPE("DatasetReader::read");
+    uint64_t numRecords = 0;
+    if (!this->valid or !getInteger(this->file, numRecords, 4))
+        return false;
+    if (numRecords == 0 or numRecords > DatasetChunk::CAPACITY)
+        return false;
+
+    auto numTiles  = static_cast<size_t>(this->boardWidth) * this->boardHeight;
+    auto tileBytes = (numTiles + 1) / 2;
+    auto mineBytes = (numTiles + 7) / 8;
+    if (!decodeColumn(this->file, this->fileSize, 4, numRecords, this->games) or
+        !decodeColumn(this->file, this->fileSize, 3, numRecords, this->moves) or
+        !decodeColumn(this->file, this->fileSize, tileBytes, numRecords, this->tiles) or
+        !decodeColumn(this->file, this->fileSize, mineBytes, numRecords, this->mines) or
+        !decodeColumn(this->file, this->fileSize, 5, numRecords, this->solver))
+        return false;
+
+    records.resize(numRecords);
+    for (auto r: std::views::iota(size_t {0}, records.size()))
+    {
+        auto& record  = records[r];
+        auto game     = &this->games[4 * r];
+        auto move     = &this->moves[3 * r];
+        record.game   = game[0] | game[1] << 8 | game[2] << 16 | static_cast<uint32_t>(game[3]) << 24;
+        record.tile   = move[0] | move[1] << 8;
+        record.button = move[2] == 2 ? sf::Mouse::Button::Right : sf::Mouse::Button::Left;
+
+        record.tiles.resize(numTiles);
+        record.mines.resize(numTiles);
+        auto tileBase = r * tileBytes;
+        auto mineBase = r * mineBytes;
+        for (auto tile: std::views::iota(size_t {0}, numTiles))
+        {
+            record.tiles[tile] = (this->tiles[tileBase + tile / 2] >> (4 * (tile % 2))) & 0xf;
+            record.mines[tile] = (this->mines[mineBase + tile / 8] >> (tile % 8)) & 1;
+        }
+
+        auto solver                   = &this->solver[5 * r];
+        auto best                     = solver[0] | solver[1] << 8;
+        auto hasBest                  = best != DatasetChunk::NO_BEST_TILE;
+        record.endgame.solved         = solver[4] & 1;
+        record.endgame.exact          = solver[4] & 2;
+        record.endgame.winProbability = static_cast<float>(solver[2] | solver[3] << 8) / 65535.0f;
+        record.endgame.bestX          = hasBest ? best % this->boardWidth : -1;
+        record.endgame.bestY          = hasBest ? best / this->boardWidth : -1;
+    }
+
+    return true;
+}
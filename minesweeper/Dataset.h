@@ -0,0 +1,227 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <filesystem>
+#include <fstream>
+#include <mutex>
+#include <ranges>
+#include <thread>
+#include <tuple>
+#include <vector>
+
+#include "Bot.h"
+#include "EndgameSolver.h"
+#include "Minesweeper.h"
+
+// Records of positions and the move played from each, gathered column by
+//   column. Every column has a fixed width per record:
+//     game   u32 number of the game the position is from
+//     move   u16 tile index, u8 1 to open or 2 to flag
+//     tiles  a nibble per tile as the player sees it, low nibble first:
+//            0-8 uncovered with that many mines around, 9 covered, 10 flagged
+//     mines  a bit per tile, set for mines, low bit first
+//     solver u16 the endgame solver's best click, or 0xffff if it has none,
+//            u16 its win probability scaled to 0-65535, u8 1 if solved plus
+//            2 if exact. Only positions within the solver's range are solved.
+//   Tiles are numbered row by row.
+class DatasetChunk
+{
+private:
+    int32_t numTiles;
+    int32_t numRecords {0};
+
+    std::vector<uint8_t> games;
+    std::vector<uint8_t> moves;
+    std::vector<uint8_t> tiles;
+    std::vector<uint8_t> mines;
+    std::vector<uint8_t> solver;
+
+public:
+    // Records in a full chunk
+    static constexpr int32_t CAPACITY {4096};
+    static constexpr uint8_t TILE_COVERED {9};
+    static constexpr uint8_t TILE_FLAGGED {10};
+
+    static constexpr uint16_t NO_BEST_TILE {0xffff};
+
+    explicit DatasetChunk(int32_t numTiles);
+
+    template<typename Board>
+    void add(Board const& board, uint32_t game, BotMove move, EndgameResult const& endgame)
+    {
+        constexpr auto WIDTH = Board::BOARD_WIDTH;
+
+        for (auto shift: {0, 8, 16, 24})
+            this->games.push_back(static_cast<uint8_t>(game >> shift));
+        auto index = move.x + move.y * WIDTH;
+        this->moves.push_back(static_cast<uint8_t>(index));
+        this->moves.push_back(static_cast<uint8_t>(index >> 8));
+        this->moves.push_back(move.button == sf::Mouse::Button::Right ? 2 : 1);
+
+        auto tileBase = this->tiles.size();
+        auto mineBase = this->mines.size();
+        this->tiles.resize(tileBase + (this->numTiles + 1) / 2);
+        this->mines.resize(mineBase + (this->numTiles + 7) / 8);
+        for (auto tile: std::views::iota(0, this->numTiles))
+        {
+            auto x = tile % WIDTH;
+            auto y = tile / WIDTH;
+
+            uint8_t value = TILE_COVERED;
+            switch (board.getTileState(x, y))
+            {
+            case TileState::UNCOVERED:
+                value = static_cast<uint8_t>(board.getMineCount(x, y));
+                break;
+            case TileState::FLAGGED:
+                value = TILE_FLAGGED;
+                break;
+            case TileState::COVERED:
+                break;
+            }
+            this->tiles[tileBase + tile / 2] |= value << (4 * (tile % 2));
+            if (board.isMine(x, y))
+                this->mines[mineBase + tile / 8] |= 1 << (tile % 8);
+        }
+
+        uint16_t best        = NO_BEST_TILE;
+        uint16_t probability = 0;
+        if (endgame.solved)
+        {
+            if (endgame.bestX >= 0)
+                best = static_cast<uint16_t>(endgame.bestX + endgame.bestY * WIDTH);
+            probability = static_cast<uint16_t>(std::clamp(endgame.winProbability, 0.0f, 1.0f) * 65535.0f + 0.5f);
+        }
+        this->solver.push_back(static_cast<uint8_t>(best));
+        this->solver.push_back(static_cast<uint8_t>(best >> 8));
+        this->solver.push_back(static_cast<uint8_t>(probability));
+        this->solver.push_back(static_cast<uint8_t>(probability >> 8));
+        this->solver.push_back(static_cast<uint8_t>((endgame.solved ? 1 : 0) | (endgame.exact ? 2 : 0)));
+
+        this->numRecords++;
+    }
+
+    inline bool isEmpty() const
+    {
+        return this->numRecords == 0;
+    }
+
+    inline bool isFull() const
+    {
+        return this->numRecords >= CAPACITY;
+    }
+
+    // Compresses the chunk into the bytes written to the file, and empties it
+    //   for the next records
+    std::vector<uint8_t> encode();
+};
+
+// Writes chunks to a file on its own thread. The file is a header followed by
+//   the chunks, all integers little-endian:
+//     header  "MSDS", u32 version, u16 width, u16 height, u16 mines
+//     chunk   u32 records, then for each column in order: u32 size, data
+//   Each column's records are xored with the record before, which leaves
+//   mostly zeros since a move changes few tiles and the mines stay put for the
+//   whole game, and then stored as runs: varint count of zeros, varint count
+//   of literal bytes, the literal bytes, until the column ends. After a write
+//   fails, chunks are dropped rather than written past a gap.
+class DatasetWriter
+{
+private:
+    // Encoded chunks waiting to be written. Producers wait for room, so memory
+    //   stays bounded however far the disk falls behind.
+    static constexpr size_t MAX_QUEUED {16};
+
+    std::ofstream file;
+    std::atomic<bool> writeFailed {false};
+    std::mutex mutex;
+    std::condition_variable condition;
+    std::thread thread;
+    bool stop {false};
+
+    std::deque<std::vector<uint8_t>> queue;
+
+    void run();
+    void checkWrite();
+
+public:
+    static constexpr uint32_t VERSION {2};
+
+    DatasetWriter(std::filesystem::path const& path, int32_t boardWidth, int32_t boardHeight, int32_t mineCount);
+    DatasetWriter(DatasetWriter const&) = delete;
+    void operator=(DatasetWriter const&) = delete;
+    // Writes whatever is still queued before returning
+    ~DatasetWriter();
+
+    inline bool isOpen() const
+    {
+        return this->file.is_open();
+    }
+
+    // True once any write has failed. Only final after finish.
+    inline bool failed() const
+    {
+        return this->writeFailed.load(std::memory_order_relaxed);
+    }
+
+    // Safe to call from any thread
+    void push(std::vector<uint8_t> chunk);
+    // Writes whatever is still queued and flushes the file. No chunks may be
+    //   pushed after.
+    void finish();
+};
+
+// A record read back from a dataset file, one byte per tile: the tile as the
+//   player saw it, with the values DatasetChunk uses, and 1 for each mine.
+//   The solver's win probability comes back rounded to the nearest 1/65535.
+struct DatasetRecord
+{
+    uint32_t game;
+    int32_t tile;
+    sf::Mouse::Button button;
+    std::vector<uint8_t> tiles;
+    std::vector<uint8_t> mines;
+    EndgameResult endgame;
+};
+
+// Reads back what a DatasetWriter wrote, a chunk at a time
+class DatasetReader
+{
+private:
+    std::ifstream file;
+    uint64_t fileSize {0};
+    bool valid {false};
+    int32_t boardWidth {0};
+    int32_t boardHeight {0};
+    int32_t mineCount {0};
+
+    // Columns of the chunk being read, kept for the next one
+    std::vector<uint8_t> games;
+    std::vector<uint8_t> moves;
+    std::vector<uint8_t> tiles;
+    std::vector<uint8_t> mines;
+    std::vector<uint8_t> solver;
+
+public:
+    explicit DatasetReader(std::filesystem::path const& path);
+
+    // False if the file could not be opened or has no header this version
+    //   understands
+    inline bool isOpen() const
+    {
+        return this->valid;
+    }
+
+    inline auto getBoardConfig() const
+    {
+        return std::make_tuple(this->boardWidth, this->boardHeight, this->mineCount);
+    }
+
+    // Reads the next chunk's records in place of the ones given. False at the
+    //   end of the file, or if the chunk is cut short or malformed.
+    bool read(std::vector<DatasetRecord>& records);
+};
@@ -0,0 +1,105 @@
+#include "BitBoard.h"
+#include "Bot.h"
+#include "Dataset.h"
+#include "EndgameSolver.h"
+#include "Minesweeper.h"
+
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <ranges>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Plays expert games with the bot on every core and records each position it
+//   moved from, with the move, the mines, and the endgame solver's best click
+//   once few enough tiles are left, for training move prediction.
+//   Usage: minesweeper-dataset <games> <output file> [threads]
+int main(int argc, char* argv[])
+{
+    using Board = ExpertBoard;
+    // Most endgames solve exactly well inside this. The rest are labelled
+    //   with the estimate, so one slow position cannot stall a worker.
+    constexpr std::chrono::milliseconds SOLVER_BUDGET {2};
+
+    if (argc < 3 or argc > 4)
+    {
+        std::cerr << "Usage: " << argv[0] << " <games> <output file> [threads]" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    auto numGames   = std::stoll(argv[1]);
+    auto numThreads = argc == 4 ? std::stoi(argv[3])
+                                : static_cast<int32_t>(std::max(std::thread::hardware_concurrency(), 1u));
+    if (numGames <= 0 or numThreads <= 0)
+    {
+        std::cerr << "Games and threads must be positive" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    DatasetWriter writer {argv[2], Board::BOARD_WIDTH, Board::BOARD_HEIGHT, Board::MINE_COUNT};
+    if (!writer.isOpen())
+    {
+        std::cerr << "Could not open " << argv[2] << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    std::atomic<int64_t> nextGame {0};
+    std::atomic<int64_t> numPositions {0};
+    auto work = [&](int32_t seed)
+    {
+        Board board;
+        DatasetChunk chunk {Board::BOARD_WIDTH * Board::BOARD_HEIGHT};
+        EndgameSolver solver;
+        EndgamePosition position;
+        std::minstd_rand rng {static_cast<uint32_t>(seed + 1)};
+        int64_t positions = 0;
+        for (int64_t game; (game = nextGame.fetch_add(1, std::memory_order_relaxed)) < numGames;)
+        {
+            board.initialize();
+            while (auto move = chooseBotMove(board, rng))
+            {
+                // The opening move is always the middle of an untouched board,
+                //   and may still move a mine out from under it, so it has no
+                //   position worth recording
+                if (board.getGameState() == GameState::GAME_ONGOING)
+                {
+                    EndgameResult endgame;
+                    if (board.getEndgamePosition(position))
+                        endgame = solver.solve(position, SOLVER_BUDGET, [] { return false; });
+                    chunk.add(board, static_cast<uint32_t>(game), *move, endgame);
+                    positions++;
+                    if (chunk.isFull())
+                        writer.push(chunk.encode());
+                }
+                board.interact(move->x, move->y, move->button);
+            }
+        }
+
+        if (!chunk.isEmpty())
+            writer.push(chunk.encode());
+        numPositions += positions;
+    };
+
+    auto start = std::chrono::steady_clock::now();
+    std::vector<std::thread> workers;
+    for (auto i: std::views::iota(1, numThreads))
+        workers.emplace_back(work, i);
+    work(0);
+    for (auto& worker: workers)
+        worker.join();
+    writer.finish();
+    auto seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    if (writer.failed())
+    {
+        std::cerr << "Could not write all of " << argv[2] << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    std::cout << "Recorded " << numPositions << " positions from " << numGames << " games in " << seconds
+              << " s on " << numThreads << " threads (" << numPositions / seconds << " positions/s)" << std::endl;
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,234 @@
+#include "DeltaSink.h"
+
+#include "Trace.h"
+
+#include <algorithm>
+#include <csignal>
+#include <iostream>
+#include <ranges>
+
+static void putInteger(std::vector<uint8_t>& out, uint64_t value, int32_t numBytes)
+{
+    for (auto i: std::views::iota(0, numBytes))
+        out.push_back(static_cast<uint8_t>(value >> (8 * i)));
+}
+
+static void putVarint(std::vector<uint8_t>& out, uint64_t value)
+{
+    while (value >= 0x80)
+    {
+        out.push_back(static_cast<uint8_t>(value | 0x80));
+        value >>= 7;
+    }
+    out.push_back(static_cast<uint8_t>(value));
+}
+
+static bool getInteger(std::istream& in, uint64_t& value, int32_t numBytes)
+{
+    uint8_t bytes[8];
+    if (!in.read(reinterpret_cast<char*>(bytes), numBytes))
+        return false;
+
+    value = 0;
+    for (auto i: std::views::iota(0, numBytes))
+        value |= static_cast<uint64_t>(bytes[i]) << (8 * i);
+    return true;
+}
+
+static bool getVarint(std::istream& in, uint64_t& value)
+{
+    value = 0;
+    for (int32_t shift = 0; shift < 64; shift += 7)
+    {
+        char byte;
+        if (!in.get(byte))
+            return false;
+        value |= static_cast<uint64_t>(byte & 0x7f) << shift;
+        if (!(byte & 0x80))
+            return true;
+    }
+    return false;
+}
+
+CallbackDeltaSink::CallbackDeltaSink(std::function<void(BoardDelta const&)> callback): callback(std::move(callback))
+{
+}
+
+void CallbackDeltaSink::publish(BoardDelta const& delta)
+{
+    this->callback(delta);
+}
+
+StreamDeltaSink::StreamDeltaSink(std::filesystem::path const& path):
+    path(path), stream(path, std::ios::binary | std::ios::trunc)
+{
+#ifndef _WIN32
+    // A viewer closing its end of a pipe would otherwise kill the game on the
+    //   next write, rather than just failing it
+    std::signal(SIGPIPE, SIG_IGN);
+#endif
+    this->thread = std::thread {&StreamDeltaSink::run, this};
+}
+
+StreamDeltaSink::~StreamDeltaSink()
+{
+    {
+        std::lock_guard lock {this->mutex};
+        this->stop = true;
+    }
+    this->condition.notify_all();
+    this->thread.join();
+}
+
+void StreamDeltaSink::publish(BoardDelta const& delta)
+{
+    TRACE_SCOPE("StreamDeltaSink::publish");
+    if (this->failed.load(std::memory_order_relaxed))
+        return;
+
+    std::vector<uint8_t> out;
+    out.reserve(40 + 4 * delta.runs.size() + delta.tiles.size());
+    putInteger(out, delta.sequence, 8);
+    putInteger(out, delta.newGame ? 1 : 0, 1);
+    putInteger(out, static_cast<uint32_t>(delta.boardWidth), 4);
+    putInteger(out, static_cast<uint32_t>(delta.boardHeight), 4);
+    putInteger(out, static_cast<uint32_t>(delta.mineCount), 4);
+    putInteger(out, static_cast<uint8_t>(delta.topology), 1);
+    putInteger(out, static_cast<uint8_t>(delta.gameState), 1);
+    putInteger(out, static_cast<uint64_t>(delta.lastClicked), 8);
+
+    putVarint(out, delta.runs.size());
+    int64_t previousEnd = 0;
+    auto tile           = delta.tiles.begin();
+    for (auto const& run: delta.runs)
+    {
+        putVarint(out, run.first - previousEnd);
+        putVarint(out, run.length);
+        out.insert(out.end(), tile, tile + run.length);
+        tile += run.length;
+        previousEnd = run.first + run.length;
+    }
+
+    {
+        std::unique_lock lock {this->mutex};
+        this->condition.wait(lock, [this] { return this->failed or this->queuedBytes < MAX_QUEUED_BYTES; });
+        if (this->failed)
+            return;
+        this->queuedBytes += out.size();
+        this->queue.push_back(std::move(out));
+    }
+    this->condition.notify_all();
+}
+
+void StreamDeltaSink::run()
+{
+    Tracer::setThreadName("Delta stream");
+    std::unique_lock lock {this->mutex};
+    while (true)
+    {
+        this->condition.wait(lock, [this] { return this->stop or !this->queue.empty(); });
+        if (this->queue.empty())
+            return;
+
+        auto bytes = std::move(this->queue.front());
+        this->queue.pop_front();
+        lock.unlock();
+
+        {
+            TRACE_SCOPE("StreamDeltaSink::write");
+            // Flushed every time, so a viewer on the other end of a pipe is
+            //   never left a move behind
+            this->stream.write(reinterpret_cast<char const*>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+            this->stream.flush();
+        }
+
+        lock.lock();
+        if (!this->stream)
+        {
+            std::cerr << "Could not write board deltas to " << this->path.string() << ", no more will be sent"
+                      << std::endl;
+            this->failed.store(true, std::memory_order_relaxed);
+            this->queue.clear();
+            this->queuedBytes = 0;
+            this->condition.notify_all();
+            return;
+        }
+        this->queuedBytes -= bytes.size();
+        this->condition.notify_all();
+    }
+}
+
+DeltaReader::DeltaReader(std::filesystem::path const& path): stream(path, std::ios::binary)
+{
+}
+
+bool DeltaReader::read(BoardDelta& delta)
+{
+    TRACE_SCOPE("DeltaReader::read");
+    uint64_t sequence    = 0;
+    uint64_t newGame     = 0;
+    uint64_t width       = 0;
+    uint64_t height      = 0;
+    uint64_t mines       = 0;
+    uint64_t topology    = 0;
+    uint64_t gameState   = 0;
+    uint64_t lastClicked = 0;
+    uint64_t numRuns     = 0;
+    if (!getInteger(this->stream, sequence, 8) or !getInteger(this->stream, newGame, 1) or
+        !getInteger(this->stream, width, 4) or !getInteger(this->stream, height, 4) or
+        !getInteger(this->stream, mines, 4) or !getInteger(this->stream, topology, 1) or
+        !getInteger(this->stream, gameState, 1) or !getInteger(this->stream, lastClicked, 8) or
+        !getVarint(this->stream, numRuns))
+        return false;
+    if (newGame > 1 or width > INT32_MAX or height > INT32_MAX or mines > INT32_MAX or
+        topology > static_cast<uint8_t>(Topology::HEXAGONAL) or gameState > static_cast<uint8_t>(GameState::GAME_LOST))
+        return false;
+
+    delta.sequence    = sequence;
+    delta.newGame     = newGame == 1;
+    delta.boardWidth  = static_cast<int32_t>(width);
+    delta.boardHeight = static_cast<int32_t>(height);
+    delta.mineCount   = static_cast<int32_t>(mines);
+    delta.topology    = static_cast<Topology>(topology);
+    delta.gameState   = static_cast<GameState>(gameState);
+    delta.lastClicked = static_cast<int64_t>(lastClicked);
+    delta.runs.clear();
+    delta.tiles.clear();
+
+    // Runs are in order and never overlap, so none can end past the last tile
+    auto numTiles    = width * height;
+    uint64_t nextRun = 0;
+    for ([[maybe_unused]] auto run: std::views::iota(uint64_t {0}, numRuns))
+    {
+        uint64_t skipped = 0;
+        uint64_t length  = 0;
+        if (!getVarint(this->stream, skipped) or !getVarint(this->stream, length))
+            return false;
+        if (skipped > numTiles - nextRun or length == 0 or length > numTiles - nextRun - skipped)
+            return false;
+
+        delta.runs.push_back({static_cast<int64_t>(nextRun + skipped), static_cast<int64_t>(length)});
+        nextRun   += skipped + length;
+        auto tile  = delta.tiles.size();
+        delta.tiles.resize(tile + length);
+        auto* out = reinterpret_cast<char*>(delta.tiles.data() + tile);
+        if (!this->stream.read(out, static_cast<std::streamsize>(length)))
+            return false;
+    }
+
+    return true;
+}
+
+void applyDelta(BoardDelta const& delta, std::vector<uint8_t>& tiles)
+{
+    auto numTiles = static_cast<size_t>(delta.boardWidth) * delta.boardHeight;
+    if (delta.newGame or tiles.size() != numTiles)
+        tiles.assign(numTiles, packTileState(TileState::COVERED));
+
+    auto tile = delta.tiles.begin();
+    for (auto const& run: delta.runs)
+    {
+        std::copy_n(tile, run.length, tiles.begin() + run.first);
+        tile += run.length;
+    }
+}
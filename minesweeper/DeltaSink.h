@@ -0,0 +1,105 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "Minesweeper.h"
+
+// Receives every delta the simulation publishes. Called on the simulation
+//   thread, so anything slow belongs on another thread.
+class DeltaSink
+{
+public:
+    virtual ~DeltaSink() = default;
+
+    virtual void publish(BoardDelta const& delta) = 0;
+};
+
+// Hands deltas to a function, for listeners in the same process
+class CallbackDeltaSink : public DeltaSink
+{
+private:
+    std::function<void(BoardDelta const&)> callback;
+
+public:
+    explicit CallbackDeltaSink(std::function<void(BoardDelta const&)> callback);
+
+    void publish(BoardDelta const& delta) override;
+};
+
+// Writes deltas to a file or named pipe from its own thread. Opening a pipe
+//   waits until something opens the other end. Every delta is written as,
+//   little-endian:
+//     u64 sequence
+//     u8  1 if it starts a new game, else 0
+//     u32 width, u32 height, u32 mines, u8 topology, u8 game state
+//     i64 tile clicked last, or -1
+//     varint number of runs, then for each run: varint tiles skipped since
+//     the end of the run before, varint length, then the run's tile bytes
+//   If a write fails, say because the viewer on the other end of a pipe went
+//   away, it is reported once and every delta after it is dropped.
+class StreamDeltaSink : public DeltaSink
+{
+private:
+    // Encoded deltas waiting to be written. Past this the simulation waits
+    //   for the reader, rather than memory growing without bound.
+    static constexpr size_t MAX_QUEUED_BYTES {size_t {64} << 20};
+
+    std::filesystem::path path;
+    std::ofstream stream;
+    std::atomic<bool> failed {false};
+    std::mutex mutex;
+    std::condition_variable condition;
+    std::thread thread;
+    bool stop {false};
+
+    std::deque<std::vector<uint8_t>> queue;
+    size_t queuedBytes {0};
+
+    void run();
+
+public:
+    explicit StreamDeltaSink(std::filesystem::path const& path);
+    StreamDeltaSink(StreamDeltaSink const&) = delete;
+    void operator=(StreamDeltaSink const&) = delete;
+    // Writes whatever is still queued before returning
+    ~StreamDeltaSink();
+
+    inline bool isOpen() const
+    {
+        return this->stream.is_open();
+    }
+
+    void publish(BoardDelta const& delta) override;
+};
+
+// Reads back what a StreamDeltaSink wrote, one delta at a time
+class DeltaReader
+{
+private:
+    std::ifstream stream;
+
+public:
+    explicit DeltaReader(std::filesystem::path const& path);
+
+    inline bool isOpen() const
+    {
+        return this->stream.is_open();
+    }
+
+    // Reads the next delta in place of the one given. False at the end of the
+    //   stream, or if the delta is cut short or malformed.
+    bool read(BoardDelta& delta);
+};
+
+// Brings a viewer's copy of the board up to date with a delta, one tile per
+//   byte numbered as in the delta. A new game starts with every tile covered.
+void applyDelta(BoardDelta const& delta, std::vector<uint8_t>& tiles);
@@ -0,0 +1,297 @@
+#include "EndgameSolver.h"
+
+#include "Trace.h"
+
+#include <algorithm>
+#include <bit>
+
+EndgameSolver::EndgameSolver()
+{
+    // SplitMix64, so the keys are the same on every run
+    uint64_t state = 0x9E3779B97F4A7C15;
+    for (auto& numbers: this->zobrist)
+    {
+        for (auto& key: numbers)
+        {
+            state += 0x9E3779B97F4A7C15;
+            auto z = state;
+            z      = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9;
+            z      = (z ^ (z >> 27)) * 0x94D049BB133111EB;
+            key    = z ^ (z >> 31);
+        }
+    }
+}
+
+bool EndgameSolver::checkAborted(uint64_t amount)
+{
+    this->work += amount;
+    if (this->work >= this->nextCheck)
+    {
+        this->nextCheck = this->work + CHECK_INTERVAL;
+        if (std::chrono::steady_clock::now() > this->deadline or (this->interrupted and this->interrupted()))
+            this->aborted = true;
+    }
+    return this->aborted;
+}
+
+bool EndgameSolver::enumerateLayouts(std::vector<uint64_t>& layouts)
+{
+    auto const& tiles       = this->position->tiles;
+    auto const& constraints = this->position->constraints;
+    auto numTiles           = static_cast<int32_t>(tiles.size());
+
+    // Tiles next to a number go first, so contradictions are found early
+    std::vector<std::vector<int32_t>> tileConstraints(numTiles);
+    for (int32_t c = 0; c < static_cast<int32_t>(constraints.size()); c++)
+        for (auto bits = constraints[c].tiles; bits; bits &= bits - 1)
+            tileConstraints[std::countr_zero(bits)].push_back(c);
+
+    std::vector<int32_t> order(numTiles);
+    for (int32_t i = 0; i < numTiles; i++)
+        order[i] = i;
+    std::ranges::stable_partition(order, [&](int32_t tile) { return !tileConstraints[tile].empty(); });
+
+    // Mines still needed by each number, and its covered tiles not yet decided
+    std::vector<int32_t> needed(constraints.size());
+    std::vector<int32_t> undecided(constraints.size());
+    for (size_t c = 0; c < constraints.size(); c++)
+    {
+        needed[c]    = constraints[c].mines;
+        undecided[c] = std::popcount(constraints[c].tiles);
+    }
+
+    auto minesLeft = this->position->minesLeft;
+    auto place     = [&](auto& self, int32_t depth, uint64_t layout, int32_t placed) -> bool
+    {
+        if (layouts.size() > MAX_LAYOUTS or this->checkAborted())
+            return false;
+
+        if (depth == numTiles)
+        {
+            if (placed == minesLeft)
+                layouts.push_back(layout);
+            return true;
+        }
+
+        auto tile      = order[depth];
+        auto remaining = numTiles - depth;
+        auto const& cs = tileConstraints[tile];
+
+        if (minesLeft - placed <= remaining - 1 and
+            std::ranges::all_of(cs, [&](int32_t c) { return undecided[c] - 1 >= needed[c]; }))
+        {
+            for (auto c: cs)
+                undecided[c]--;
+            auto ok = self(self, depth + 1, layout, placed);
+            for (auto c: cs)
+                undecided[c]++;
+            if (!ok)
+                return false;
+        }
+
+        if (placed < minesLeft and std::ranges::all_of(cs, [&](int32_t c) { return needed[c] > 0; }))
+        {
+            for (auto c: cs)
+            {
+                undecided[c]--;
+                needed[c]--;
+            }
+            auto ok = self(self, depth + 1, layout | uint64_t {1} << tile, placed + 1);
+            for (auto c: cs)
+            {
+                undecided[c]++;
+                needed[c]++;
+            }
+            if (!ok)
+                return false;
+        }
+
+        return true;
+    };
+
+    return place(place, 0, 0, 0) and layouts.size() <= MAX_LAYOUTS;
+}
+
+uint64_t EndgameSolver::reveal(int32_t tile, uint64_t layout, uint64_t covered, uint64_t& key) const
+{
+    // Same cascade as GameBoard::floodFill, restricted to the covered tiles.
+    //   Numbers leave out uncovered tiles and known mines, which would only add
+    //   the same amount to a tile in every layout.
+    auto const& tiles = this->position->tiles;
+    uint64_t revealed = uint64_t {1} << tile;
+    uint64_t pending  = revealed;
+    while (pending)
+    {
+        auto current = std::countr_zero(pending);
+        pending &= pending - 1;
+
+        auto number = std::popcount(tiles[current].neighbours & layout);
+        key ^= this->zobrist[current][number];
+        if (number == 0)
+        {
+            auto next = tiles[current].neighbours & covered & ~revealed;
+            revealed |= next;
+            pending |= next;
+        }
+    }
+
+    return revealed;
+}
+
+float EndgameSolver::search(std::vector<uint64_t> const& layouts, uint64_t covered, uint64_t key, int32_t depth,
+                            int32_t* bestTile, bool& exact)
+{
+    if (this->checkAborted())
+        return 0;
+
+    // Every layout has the same number of mines, so once that many tiles are
+    //   left covered they are all mines
+    if (std::popcount(covered) == this->position->minesLeft)
+        return 1;
+
+    if (!bestTile)
+    {
+        auto found = this->table.find(key);
+        if (found != this->table.end() and (found->second.exact or found->second.depth >= depth))
+        {
+            exact &= found->second.exact;
+            return found->second.value;
+        }
+    }
+
+    auto total = layouts.size();
+    std::array<uint32_t, MAX_ENDGAME_TILES> mineCounts {};
+    for (auto layout: layouts)
+        for (auto bits = layout; bits; bits &= bits - 1)
+            mineCounts[std::countr_zero(bits)]++;
+
+    // Uncovering a tile that is safe in every layout never hurts, so when
+    //   there is one it is the only move worth trying and costs no depth
+    std::vector<int32_t> moves;
+    auto isGuess = true;
+    for (auto bits = covered; bits; bits &= bits - 1)
+    {
+        auto tile = std::countr_zero(bits);
+        if (mineCounts[tile] == 0)
+        {
+            moves   = {tile};
+            isGuess = false;
+            break;
+        }
+        if (mineCounts[tile] < total)
+            moves.push_back(tile);
+    }
+    std::ranges::stable_sort(moves, {}, [&](int32_t tile) { return mineCounts[tile]; });
+
+    // Out of depth, score the position by its safest guess alone
+    if (isGuess and depth == 0)
+    {
+        exact = false;
+        return moves.empty() ? 0.0f : static_cast<float>(total - mineCounts[moves.front()]) / total;
+    }
+
+    float best      = 0;
+    auto bestMove   = -1;
+    auto nodeExact  = true;
+    auto childDepth = isGuess ? depth - 1 : depth;
+
+    std::vector<std::pair<uint64_t, uint64_t>> outcomes;
+    std::vector<uint64_t> group;
+    for (auto tile: moves)
+    {
+        // A click can't win more often than it survives, and the moves are
+        //   sorted safest first
+        auto survival = static_cast<float>(total - mineCounts[tile]) / total;
+        if (survival <= best)
+            break;
+
+        // A node near the root can sort tens of thousands of layouts per
+        //   move, far more than the check interval assumes of a node
+        if (this->checkAborted(layouts.size()))
+            return 0;
+        outcomes.clear();
+        for (auto layout: layouts)
+        {
+            if (layout >> tile & 1)
+                continue;
+            auto childKey = key;
+            this->reveal(tile, layout, covered, childKey);
+            outcomes.emplace_back(childKey, layout);
+        }
+        std::ranges::sort(outcomes);
+
+        // Layouts that show the same numbers form one child position
+        float value = 0;
+        for (size_t begin = 0; begin < outcomes.size();)
+        {
+            auto end = begin;
+            group.clear();
+            while (end < outcomes.size() and outcomes[end].first == outcomes[begin].first)
+                group.push_back(outcomes[end++].second);
+
+            uint64_t ignored = 0;
+            auto revealed    = this->reveal(tile, group.front(), covered, ignored);
+            value += group.size() * this->search(group, covered & ~revealed, outcomes[begin].first, childDepth,
+                                                 nullptr, nodeExact);
+            if (this->aborted)
+                return 0;
+            begin = end;
+        }
+        value /= total;
+
+        if (value > best)
+        {
+            best     = value;
+            bestMove = tile;
+        }
+    }
+
+    exact &= nodeExact;
+    this->table[key] = {best, depth, nodeExact};
+    if (bestTile)
+        *bestTile = bestMove;
+    return best;
+}
+
+EndgameResult EndgameSolver::solve(EndgamePosition const& position, std::chrono::milliseconds budget,
+                                   std::function<bool()> interrupted)
+{
+    TRACE_SCOPE("EndgameSolver::solve");
+    this->position    = &position;
+    this->deadline    = std::chrono::steady_clock::now() + budget;
+    this->interrupted = std::move(interrupted);
+    this->work        = 0;
+    this->nextCheck   = CHECK_INTERVAL;
+    this->aborted     = false;
+    this->table.clear();
+
+    EndgameResult result;
+    auto numTiles = static_cast<int32_t>(position.tiles.size());
+    if (numTiles == 0 or numTiles > MAX_ENDGAME_TILES)
+        return result;
+
+    std::vector<uint64_t> layouts;
+    if (!this->enumerateLayouts(layouts) or layouts.empty())
+        return result;
+
+    auto covered = numTiles == 64 ? ~uint64_t {0} : (uint64_t {1} << numTiles) - 1;
+    for (int32_t depth = 1; depth <= numTiles; depth++)
+    {
+        auto exact    = true;
+        auto bestTile = -1;
+        auto value    = this->search(layouts, covered, 0, depth, &bestTile, exact);
+        // A deeper search cut short says nothing, so keep the last full one
+        if (this->aborted)
+            break;
+
+        result.solved         = true;
+        result.exact          = exact;
+        result.winProbability = value;
+        result.bestX          = bestTile < 0 ? -1 : position.tiles[bestTile].x;
+        result.bestY          = bestTile < 0 ? -1 : position.tiles[bestTile].y;
+        if (exact)
+            break;
+    }
+
+    return result;
+}
@@ -0,0 +1,97 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <unordered_map>
+#include <vector>
+
+// Endgames with more covered tiles than this are not solved, so that any set
+//   of covered tiles fits in one word
+constexpr int32_t MAX_ENDGAME_TILES {64};
+
+// What the player can see of a board near the end of a game. Tiles are the
+//   covered (or flagged) tiles not already known to be mines; sets of them are
+//   bitmasks over that list. Known mines are left out of the counts as well.
+struct EndgamePosition
+{
+    struct Tile
+    {
+        int32_t x;
+        int32_t y;
+        // Covered tiles next to this one
+        uint64_t neighbours;
+    };
+
+    // An uncovered number and the covered tiles around it
+    struct Constraint
+    {
+        uint64_t tiles;
+        int32_t mines;
+    };
+
+    int32_t minesLeft {0};
+    std::vector<Tile> tiles;
+    std::vector<Constraint> constraints;
+};
+
+struct EndgameResult
+{
+    bool solved {false};
+    // False if the search ran out of time before following every line to the
+    //   end, in which case the deepest lines are scored by their best guess
+    bool exact {false};
+    float winProbability {0};
+    int32_t bestX {-1};
+    int32_t bestY {-1};
+};
+
+// Finds the win probability under best play, and the click that achieves it.
+//   Every mine layout that fits the visible numbers is equally likely, so a
+//   click is scored by grouping the layouts by what the click would reveal and
+//   searching each group in turn.
+class EndgameSolver
+{
+private:
+    // Positions with more possible mine layouts than this are not solved
+    static constexpr size_t MAX_LAYOUTS {size_t {1} << 16};
+    static constexpr uint64_t CHECK_INTERVAL {1024};
+
+    struct Entry
+    {
+        float value;
+        int32_t depth;
+        bool exact;
+    };
+
+    // A position is identified by the tiles revealed since the root and the
+    //   numbers they showed, hashed by xoring one key per tile and number
+    std::array<std::array<uint64_t, 9>, MAX_ENDGAME_TILES> zobrist;
+    std::unordered_map<uint64_t, Entry> table;
+
+    EndgamePosition const* position {nullptr};
+    std::chrono::steady_clock::time_point deadline;
+    std::function<bool()> interrupted;
+    // Work done so far, in layouts visited, and when to next look at the clock
+    uint64_t work {0};
+    uint64_t nextCheck {0};
+    bool aborted {false};
+
+    // Counts work done, and every so often checks the deadline and interrupt.
+    //   True once either has stopped the solve.
+    bool checkAborted(uint64_t amount = 1);
+    // False if there are too many layouts or the solve was stopped
+    bool enumerateLayouts(std::vector<uint64_t>& layouts);
+    uint64_t reveal(int32_t tile, uint64_t layout, uint64_t covered, uint64_t& key) const;
+    float search(std::vector<uint64_t> const& layouts, uint64_t covered, uint64_t key, int32_t depth,
+                 int32_t* bestTile, bool& exact);
+
+public:
+    EndgameSolver();
+
+    // Searches with iterative deepening on the number of guesses until the
+    //   result is exact, the budget runs out, or interrupted returns true
+    EndgameResult solve(EndgamePosition const& position, std::chrono::milliseconds budget,
+                        std::function<bool()> interrupted);
+};
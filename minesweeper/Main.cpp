@@ -1,11 +1,21 @@
+#include "AllocationCounter.h"
+#include "DeltaSink.h"
 #include "Minesweeper.h"
+#include "RankIndex.h"
+#include "Simulation.h"
+#include "Spectator.h"
+#include "Thumbnail.h"
+#include "Trace.h"
 
+#include <algorithm>
 #include <filesystem>
 #include <iostream>
+#include <optional>
 #include <queue>
 #include <random>
 #include <ranges>
 #include <set>
+#include <string_view>
 #include <vector>
 
 #include <SFML/Graphics.hpp>
@@ -19,7 +29,13 @@ constexpr uint32_t BASE_SIZE {600};
 constexpr uint32_t WINDOW_WIDTH {BASE_SIZE};
 constexpr uint32_t WINDOW_HEIGHT {BASE_SIZE};
 constexpr float UI_SCALE {0.5};
+// The spectator grid is scaled down to fit a window this big
+constexpr float SPECTATOR_SIZE {1200};
 constexpr char const* WINDOW_TITLE {"Minesweeper!"};
+constexpr char const* TRACE_PATH {"minesweeper-trace.json"};
+constexpr char const* IMAGE_PATH {"minesweeper-board.png"};
+// Longest side of a saved board image, in pixels
+constexpr int32_t IMAGE_SIZE {4096};
 sf::Color const BACKGROUND_COLOR {0xE0E0E0FF};
 sf::Color const ALERT_COLOR {0x4A0202FF};
 
@@ -29,10 +45,11 @@ private:
     int32_t boardWidth;
     int32_t boardHeight;
     int32_t mineCount;
+    Topology topology;
 
 public:
-    GameType(int32_t boardWidth, int32_t boardHeight, int32_t mineCount):
-        boardWidth(boardWidth), boardHeight(boardHeight), mineCount(mineCount)
+    GameType(int32_t boardWidth, int32_t boardHeight, int32_t mineCount, Topology topology = Topology::SQUARE):
+        boardWidth(boardWidth), boardHeight(boardHeight), mineCount(mineCount), topology(topology)
     {
     }
 
@@ -50,25 +67,39 @@ public:
     {
         return this->mineCount;
     }
+
+    inline auto getTopology() const
+    {
+        return this->topology;
+    }
 };
 
 struct GameTypeLT
 {
-    bool operator()(GameType const& lhs, GameType const& rhs)
+    bool operator()(GameType const& lhs, GameType const& rhs) const
     {
         if ((lhs.getBoardWidth() <=> rhs.getBoardWidth()) != 0)
             return (lhs.getBoardWidth() <=> rhs.getBoardWidth()) < 0;
         if ((lhs.getBoardHeight() <=> rhs.getBoardHeight()) != 0)
             return (lhs.getBoardHeight() <=> rhs.getBoardHeight()) < 0;
-        return lhs.getMineCount() < rhs.getMineCount();
+        if ((lhs.getMineCount() <=> rhs.getMineCount()) != 0)
+            return (lhs.getMineCount() <=> rhs.getMineCount()) < 0;
+        return lhs.getTopology() < rhs.getTopology();
     }
 };
 
+// Every win recorded for one game type, indexed by each score
+struct ScoreHistory
+{
+    RankIndex<int32_t> times;
+    RankIndex<int32_t> clicks;
+    RankIndex<float, std::greater<float>> efficiencies;
+};
+
 class HighScoreManager
 {
 private:
-    std::map<GameType, int32_t, GameTypeLT> clickTable;
-    std::map<GameType, int32_t, GameTypeLT> timeTable;
+    std::map<GameType, ScoreHistory, GameTypeLT> histories;
 
     HighScoreManager()
     {
@@ -85,6 +116,20 @@ public:
 
         return instance;
     }
+
+    void submitScore(GameType const& gameType, sf::Time time, GameStats const& stats)
+    {
+        auto& history = this->histories[gameType];
+        history.times.insert(time.asMilliseconds());
+        history.clicks.insert(stats.clicks);
+        history.efficiencies.insert(stats.getEfficiency());
+    }
+
+    ScoreHistory const* getHistory(GameType const& gameType) const
+    {
+        auto it = this->histories.find(gameType);
+        return it == this->histories.end() ? nullptr : &it->second;
+    }
 };
 
 class MainApp
@@ -92,35 +137,57 @@ class MainApp
 private:
     sf::RenderWindow window;
 
-    GameBoard gameBoard;
+    // Game logic runs on its own thread; this one only handles input and
+    //   draws the latest snapshot
+    GameSimulation simulation;
+    BoardView boardView;
+    std::tuple<uint32_t, uint32_t> drawableSize;
     bool firstRun {true};
     bool debugAssist {false};
     bool lmbHeld {false};
 
+    // Bot games shown instead of the player's board while set
+    std::optional<SpectatorGrid> spectatorGrid;
+
+    // Shown against the leaderboard until the next game starts
+    std::optional<GameResult> lastWin;
+
+    // Allocations made inside BoardView::draw. Like the simulation's own
+    //   count, this is expected to stay at zero once a game is underway.
+    uint64_t hotPathAllocations {0};
+
     float scaleX {1.0};
     float scaleY {1.0};
     float offsetX;
     float offsetY;
     float menuBarHeight {0.0};
 
+    // First tile of the region shown, as last asked of the simulation
+    int32_t viewportX {0};
+    int32_t viewportY {0};
+
     sf::Transform boardTransform;
 
+    // Only the snapshot's region is drawn, so positions are offset by where
+    //   it starts to get back to board tiles
     inline float relativeToBoardX(int32_t pos) const
     {
-        return (pos - this->offsetX) / TILE_SIZE / UI_SCALE;
+        return (pos - this->offsetX) / TILE_SIZE / UI_SCALE + this->simulation.getSnapshot().regionX;
     }
 
     inline float relativeToBoardY(int32_t pos) const
     {
-        return (pos - this->offsetY) / TILE_SIZE / UI_SCALE;
+        return (pos - this->offsetY) / TILE_SIZE / UI_SCALE + this->simulation.getSnapshot().regionY;
     }
 
 public:
-    MainApp(uint32_t boardWidth = 16, uint32_t boardHeight = 16, uint32_t mineCount = 40):
+    MainApp(std::vector<std::unique_ptr<DeltaSink>> deltaSinks, uint32_t boardWidth = 16, uint32_t boardHeight = 16,
+            uint32_t mineCount = 40):
         window(sf::VideoMode(WINDOW_WIDTH, WINDOW_HEIGHT), WINDOW_TITLE, sf::Style::Default ^ sf::Style::Resize),
-        gameBoard(boardWidth, boardHeight, mineCount)
+        simulation(boardWidth, boardHeight, mineCount, std::move(deltaSinks))
     {
         consoleLog("Initializing app...");
+        this->boardView.setSnapshot(this->simulation.getSnapshot());
         this->window.setFramerateLimit(60);
         std::ignore = ImGui::SFML::Init(this->window);
     }
@@ -130,17 +197,114 @@ public:
         ImGui::SFML::Shutdown();
     }
 
+    // The window is resized once the new board's snapshot comes back
     void startNewGame(uint32_t boardWidth, uint32_t boardHeight, uint32_t mineCount)
+    {
+        this->startNewGame(boardWidth, boardHeight, mineCount, this->simulation.getSnapshot().topology);
+    }
+
+    void startNewGame(Topology topology)
+    {
+        auto const& snapshot = this->simulation.getSnapshot();
+        this->startNewGame(snapshot.boardWidth, snapshot.boardHeight, snapshot.mineCount, topology);
+    }
+
+    void startNewGame(uint32_t boardWidth, uint32_t boardHeight, uint32_t mineCount, Topology topology)
     {
         // TODO: Modal popup to confirm if a game is ongoing
-        this->gameBoard.initialize(boardWidth, boardHeight, mineCount);
+        BoardCommand command;
+        command.type        = CommandType::NEW_GAME;
+        command.boardWidth  = boardWidth;
+        command.boardHeight = boardHeight;
+        command.mineCount   = mineCount;
+        command.topology    = topology;
+        this->simulation.post(command);
+    }
+
+    void recordWin(GameResult const& result)
+    {
+        GameType gameType {result.boardWidth, result.boardHeight, result.mineCount, result.topology};
+        HighScoreManager::getInstance().submitScore(gameType, result.finishTime, result.stats);
+        this->lastWin = result;
+    }
+
+    void showLeaderboard(GameResult const& result) const
+    {
+        GameType gameType {result.boardWidth, result.boardHeight, result.mineCount, result.topology};
+        auto const* history = HighScoreManager::getInstance().getHistory(gameType);
+        if (!history)
+            return;
+
+        constexpr int64_t TOP_COUNT {10};
+
+        auto time = result.finishTime.asMilliseconds();
+        ImGui::Separator();
+        ImGui::Text("Rank: #%lld of %lld", static_cast<long long>(history->times.getRank(time)),
+                    static_cast<long long>(history->times.size()));
+        ImGui::Text("Faster than %.1f%% of wins", history->times.getPercentile(time));
+        ImGui::Text("Efficiency rank: #%lld",
+                    static_cast<long long>(history->efficiencies.getRank(result.stats.getEfficiency())));
+
+        ImGui::Separator();
+        for (auto i: std::views::iota(int64_t {0}, std::min(TOP_COUNT, history->times.size())))
+            ImGui::Text("%2lld. %.3fs", static_cast<long long>(i + 1), history->times.select(i) / 1000.0f);
+    }
+
+    // Traces go to the working directory, to be opened in chrome://tracing
+    //   or Perfetto
+    void toggleTracing()
+    {
+        auto& tracer = Tracer::getInstance();
+        if (Tracer::isEnabled())
+            tracer.stop(TRACE_PATH);
+        else
+            tracer.start();
+    }
+
+    // Drawn on the CPU like the thumbnails, so boards of any size can be saved
+    //   without a render texture
+    void saveBoardImage()
+    {
+        auto const& snapshot = this->simulation.getSnapshot();
+        ThumbnailRenderer renderer {ThumbnailRenderer::fitTileSize(snapshot, IMAGE_SIZE)};
+        Thumbnail image;
+        renderer.render(snapshot, image);
+        if (!image.saveToFile(IMAGE_PATH))
+            std::cerr << "Could not write " << IMAGE_PATH << std::endl;
+    }
+
+    void pan(int32_t dx, int32_t dy)
+    {
+        auto const& snapshot = this->simulation.getSnapshot();
+        this->viewportX      = std::clamp(this->viewportX + dx * PAN_STEP, 0,
+                                          std::max(snapshot.boardWidth - snapshot.regionWidth, 0));
+        this->viewportY      = std::clamp(this->viewportY + dy * PAN_STEP, 0,
+                                          std::max(snapshot.boardHeight - snapshot.regionHeight, 0));
+
+        BoardCommand command;
+        command.type = CommandType::VIEWPORT;
+        command.x    = static_cast<float>(this->viewportX);
+        command.y    = static_cast<float>(this->viewportY);
+        this->simulation.post(command);
+    }
+
+    void spectate(int32_t numBoards)
+    {
+        if (numBoards > 0)
+            this->spectatorGrid.emplace(numBoards);
+        else
+            this->spectatorGrid.reset();
+        this->lmbHeld = false;
         this->resizeWindow();
     }
 
     void resizeWindow()
     {
-        auto [boardWidth, boardHeight]    = this->gameBoard.getDrawableSize();
-        auto [boardOffsetX, boardOffsetY] = this->gameBoard.getBoardOffset();
+        this->drawableSize = this->spectatorGrid ? this->spectatorGrid->getDrawableSize()
+                                                 : this->boardView.getDrawableSize();
+
+        auto [boardWidth, boardHeight]    = this->drawableSize;
+        auto [boardOffsetX, boardOffsetY] = this->boardView.getBoardOffset();
         // Okay so this is really dumb. When you resize the window, everything
         //   drawn assumes that the window has its original window size! So
         //   things get stretched around and stuff... you're gonna need to
@@ -149,13 +313,15 @@ public:
         //   with that lmao
         // If you can, don't resize the window -- keep it the same size. Create
         //   a view instead and tinker around with that.
-        this->window.setSize({static_cast<uint32_t>(UI_SCALE * boardWidth),
-                              static_cast<uint32_t>(UI_SCALE * boardHeight + this->menuBarHeight)});
+        auto windowScale = this->spectatorGrid ? std::min(SPECTATOR_SIZE / boardWidth, SPECTATOR_SIZE / boardHeight)
+                                               : UI_SCALE;
+        this->window.setSize({static_cast<uint32_t>(windowScale * boardWidth),
+                              static_cast<uint32_t>(windowScale * boardHeight + this->menuBarHeight)});
 
         this->scaleX         = static_cast<float>(WINDOW_WIDTH) / boardWidth;
         this->scaleY         = (static_cast<float>(WINDOW_HEIGHT) - this->menuBarHeight) / boardHeight;
-        this->offsetX        = UI_SCALE * boardOffsetX;
-        this->offsetY        = UI_SCALE * boardOffsetY + this->menuBarHeight;
+        this->offsetX        = windowScale * boardOffsetX;
+        this->offsetY        = windowScale * boardOffsetY + this->menuBarHeight;
 
         this->boardTransform = sf::Transform {};
         this->boardTransform.translate(0, 0 + this->menuBarHeight).scale({this->scaleX, this->scaleY});
@@ -164,118 +330,259 @@ public:
     void operator()()
     {
         consoleLog("Starting event loop...");
+        Tracer::setThreadName("Render");
         sf::Clock deltaClock;
         sf::Event event;
-        float boardX;
-        float boardY;
+        BoardCommand command;
+        GameResult result;
         while (this->window.isOpen())
         {
-            while (this->window.pollEvent(event))
-            {
-                ImGui::SFML::ProcessEvent(this->window, event);
-                auto imguiMouseCap = ImGui::GetIO().WantCaptureMouse;
-                auto imguiKeyCap   = ImGui::GetIO().WantCaptureKeyboard;
+            TRACE_SCOPE("MainApp::frame");
+            if (Tracer::isEnabled())
+                Tracer::getInstance().collect();
 
-                switch (event.type)
+            {
+                TRACE_SCOPE("MainApp::pollEvents");
+                while (this->window.pollEvent(event))
                 {
-                case sf::Event::Closed:
-                    this->window.close();
-                    break;
-                case sf::Event::MouseButtonPressed:
-                    if (imguiMouseCap)
-                        continue;
-                    if (event.mouseButton.button == sf::Mouse::Button::Left)
-                    {
-                        this->lmbHeld = true;
-                        boardX        = this->relativeToBoardX(event.mouseButton.x);
-                        boardY        = this->relativeToBoardY(event.mouseButton.y);
-                        this->gameBoard.telegraph(boardX, boardY);
-                    }
-                    break;
-                case sf::Event::MouseMoved:
-                    if (imguiMouseCap)
-                        continue;
-                    if (this->lmbHeld)
-                    {
-                        boardX = this->relativeToBoardX(event.mouseMove.x);
-                        boardY = this->relativeToBoardY(event.mouseMove.y);
-                        this->gameBoard.telegraph(boardX, boardY);
-                    }
-                    break;
-                case sf::Event::MouseButtonReleased:
-                    if (imguiMouseCap)
-                        continue;
-                    this->lmbHeld = false;
-                    this->gameBoard.clearTelegraph();
-                    switch (this->gameBoard.getGameState())
+                    ImGui::SFML::ProcessEvent(this->window, event);
+                    auto imguiMouseCap = ImGui::GetIO().WantCaptureMouse;
+                    auto imguiKeyCap   = ImGui::GetIO().WantCaptureKeyboard;
+
+                    switch (event.type)
                     {
-                    case GameState::GAME_NOT_STARTED:
-                    case GameState::GAME_ONGOING:
-                        boardX = this->relativeToBoardX(event.mouseButton.x);
-                        boardY = this->relativeToBoardY(event.mouseButton.y);
-                        this->gameBoard.interact(boardX, boardY, event.mouseButton.button);
+                    case sf::Event::Closed:
+                        this->window.close();
+                        break;
+                    case sf::Event::MouseButtonPressed:
+                        if (imguiMouseCap or this->spectatorGrid)
+                            continue;
+                        if (event.mouseButton.button == sf::Mouse::Button::Left)
+                        {
+                            this->lmbHeld = true;
+                            command.type  = CommandType::TELEGRAPH;
+                            command.x     = this->relativeToBoardX(event.mouseButton.x);
+                            command.y     = this->relativeToBoardY(event.mouseButton.y);
+                            this->simulation.post(command);
+                        }
+                        break;
+                    case sf::Event::MouseMoved:
+                        if (imguiMouseCap or this->spectatorGrid)
+                            continue;
+                        if (this->lmbHeld)
+                        {
+                            command.type = CommandType::TELEGRAPH;
+                            command.x    = this->relativeToBoardX(event.mouseMove.x);
+                            command.y    = this->relativeToBoardY(event.mouseMove.y);
+                            this->simulation.post(command);
+                        }
                         break;
-                    case GameState::GAME_WON:
-                    case GameState::GAME_LOST:
-                        this->gameBoard.initialize();
+                    case sf::Event::MouseButtonReleased:
+                        if (imguiMouseCap or this->spectatorGrid)
+                            continue;
+                        this->lmbHeld = false;
+                        // The simulation decides whether this is a click or a
+                        //   restart, since only it knows if the game is over yet
+                        command.type     = CommandType::RELEASE;
+                        command.x        = this->relativeToBoardX(event.mouseButton.x);
+                        command.y        = this->relativeToBoardY(event.mouseButton.y);
+                        command.mouseBtn = event.mouseButton.button;
+                        this->simulation.post(command);
+                        break;
+                    case sf::Event::KeyPressed:
+                        if (imguiKeyCap or this->spectatorGrid)
+                            continue;
+                        if (event.key.code == sf::Keyboard::Key::Left)
+                            this->pan(-1, 0);
+                        if (event.key.code == sf::Keyboard::Key::Right)
+                            this->pan(1, 0);
+                        if (event.key.code == sf::Keyboard::Key::Up)
+                            this->pan(0, -1);
+                        if (event.key.code == sf::Keyboard::Key::Down)
+                            this->pan(0, 1);
+                        break;
+                    case sf::Event::KeyReleased:
+                        if (imguiKeyCap)
+                            continue;
+                        if (event.key.code == sf::Keyboard::Key::F12)
+                            this->debugAssist = !this->debugAssist;
+                        if (event.key.code == sf::Keyboard::Key::F11)
+                            this->toggleTracing();
+                        if (event.key.code == sf::Keyboard::Key::F10 and !this->spectatorGrid)
+                            this->saveBoardImage();
+                    default:
                         break;
                     }
-                    break;
-                case sf::Event::KeyReleased:
-                    if (imguiKeyCap)
-                        continue;
-                    if (event.key.code == sf::Keyboard::Key::F12)
-                        this->debugAssist = !this->debugAssist;
-                default:
-                    break;
                 }
             }
 
-            ImGui::SFML::Update(this->window, deltaClock.restart());
-
-            if (ImGui::BeginMainMenuBar())
             {
-                this->menuBarHeight = ImGui::GetWindowSize().y;
+                TRACE_SCOPE("MainApp::updateUi");
+                if (this->simulation.update())
+                {
+                    this->boardView.setSnapshot(this->simulation.getSnapshot());
+                    if (this->simulation.getSnapshot().gameState != GameState::GAME_WON)
+                        this->lastWin.reset();
+                    if (!this->firstRun and !this->spectatorGrid and
+                        this->boardView.getDrawableSize() != this->drawableSize)
+                        this->resizeWindow();
+                }
+                while (this->simulation.popResult(result))
+                    this->recordWin(result);
+
+                auto const& snapshot = this->simulation.getSnapshot();
 
-                if (ImGui::BeginMenu("New Game"))
+                if (this->spectatorGrid)
+                    this->spectatorGrid->update();
+
+                ImGui::SFML::Update(this->window, deltaClock.restart());
+
+                if (ImGui::BeginMainMenuBar())
                 {
-                    if (ImGui::MenuItem("Beginner (9x9)"))
-                        this->startNewGame(9, 9, 10);
-                    if (ImGui::MenuItem("Intermediate (16x16)"))
-                        this->startNewGame(16, 16, 40);
-                    if (ImGui::MenuItem("Expert (30x16)"))
-                        this->startNewGame(30, 16, 99);
+                    this->menuBarHeight = ImGui::GetWindowSize().y;
+
+                    if (ImGui::BeginMenu("New Game"))
+                    {
+                        if (ImGui::MenuItem("Beginner (9x9)"))
+                            this->startNewGame(9, 9, 10);
+                        if (ImGui::MenuItem("Intermediate (16x16)"))
+                            this->startNewGame(16, 16, 40);
+                        if (ImGui::MenuItem("Expert (30x16)"))
+                            this->startNewGame(30, 16, 99);
+
+                        ImGui::Separator();
+
+                        if (ImGui::MenuItem("Custom..."))
+                        {
+                            // TODO: Modal popup to configure game settings
+                        }
+
+                        ImGui::EndMenu();
+                    }
+
+                    if (ImGui::BeginMenu("Board"))
+                    {
+                        auto topology = snapshot.topology;
+                        if (ImGui::MenuItem("Square", nullptr, topology == Topology::SQUARE))
+                            this->startNewGame(Topology::SQUARE);
+                        if (ImGui::MenuItem("Torus", nullptr, topology == Topology::TORUS))
+                            this->startNewGame(Topology::TORUS);
+                        if (ImGui::MenuItem("Hexagonal", nullptr, topology == Topology::HEXAGONAL))
+                            this->startNewGame(Topology::HEXAGONAL);
+
+                        ImGui::EndMenu();
+                    }
+
+                    if (ImGui::BeginMenu("Spectate"))
+                    {
+                        if (ImGui::MenuItem("64 bots"))
+                            this->spectate(64);
+                        if (ImGui::MenuItem("256 bots"))
+                            this->spectate(256);
+                        if (ImGui::MenuItem("Stop", nullptr, false, this->spectatorGrid.has_value()))
+                            this->spectate(0);
+
+                        ImGui::EndMenu();
+                    }
 
-                    ImGui::Separator();
+                    ImGui::EndMainMenuBar();
+                }
 
-                    if (ImGui::MenuItem("Custom..."))
+                if (this->spectatorGrid)
+                {
+                    ImGui::SetNextWindowPos({ImGui::GetIO().DisplaySize.x, this->menuBarHeight}, ImGuiCond_Always,
+                                            {1, 0});
+                    ImGui::SetNextWindowBgAlpha(0.75);
+                    if (ImGui::Begin("Spectating", nullptr, ImGuiWindowFlags_NoDecoration | ImGuiWindowFlags_NoInputs))
+                    {
+                        auto const& grid = *this->spectatorGrid;
+                        ImGui::Text("Bots: %d", grid.getNumBoards());
+                        ImGui::Text("Won: %d  Lost: %d", grid.getNumWins(), grid.getNumLosses());
+                    }
+                    ImGui::End();
+                }
+                else if (snapshot.gameState == GameState::GAME_WON or snapshot.gameState == GameState::GAME_LOST)
+                {
+                    auto const& stats = snapshot.stats;
+                    ImGui::SetNextWindowPos({ImGui::GetIO().DisplaySize.x, this->menuBarHeight}, ImGuiCond_Always,
+                                            {1, 0});
+                    ImGui::SetNextWindowBgAlpha(0.75);
+                    if (ImGui::Begin("Statistics", nullptr, ImGuiWindowFlags_NoDecoration | ImGuiWindowFlags_NoInputs))
                     {
-                        // TODO: Modal popup to configure game settings
+                        ImGui::Text("Time: %.3fs", snapshot.finishTime.asSeconds());
+                        ImGui::Text("3BV: %d", stats.boardValue);
+                        ImGui::Text("Clicks: %d (%d effective)", stats.clicks, stats.effectiveClicks);
+                        ImGui::Text("Efficiency: %.1f%%", stats.getEfficiency());
+                        // How the game would have gone with perfect play from
+                        //   the last position the solver saw
+                        if (snapshot.endgame.solved)
+                            ImGui::Text("Best play odds before last click: %.1f%%%s",
+                                        100.0f * snapshot.endgame.winProbability,
+                                        snapshot.endgame.exact ? "" : " (estimate)");
+                        if (snapshot.gameState == GameState::GAME_WON and this->lastWin)
+                            this->showLeaderboard(*this->lastWin);
                     }
+                    ImGui::End();
+                }
+                // The solver's pick would play the game for the player, so it
+                //   is only shown alongside the other debug assists
+                else if (this->debugAssist and snapshot.gameState == GameState::GAME_ONGOING and
+                         snapshot.endgame.solved)
+                {
+                    auto const& endgame = snapshot.endgame;
+                    ImGui::SetNextWindowPos({ImGui::GetIO().DisplaySize.x, this->menuBarHeight}, ImGuiCond_Always,
+                                            {1, 0});
+                    ImGui::SetNextWindowBgAlpha(0.75);
+                    if (ImGui::Begin("Endgame", nullptr, ImGuiWindowFlags_NoDecoration | ImGuiWindowFlags_NoInputs))
+                    {
+                        ImGui::Text("Best play wins: %.1f%%%s", 100.0f * endgame.winProbability,
+                                    endgame.exact ? "" : " (estimate)");
+                        if (endgame.bestX >= 0)
+                            ImGui::Text("Best click: column %d, row %d", endgame.bestX + 1, endgame.bestY + 1);
+                    }
+                    ImGui::End();
+                }
 
-                    ImGui::EndMenu();
+#ifdef DEBUG
+                ImGui::SetNextWindowPos({0, this->menuBarHeight});
+                ImGui::SetNextWindowBgAlpha(0.5);
+                if (ImGui::Begin("Debug", nullptr, ImGuiWindowFlags_NoDecoration | ImGuiWindowFlags_NoInputs))
+                {
+                    auto allocations = snapshot.hotPathAllocations + this->hotPathAllocations;
+                    ImGui::Text("Hot path allocations: %llu", static_cast<unsigned long long>(allocations));
                 }
+                ImGui::End();
+#endif
 
-                ImGui::EndMainMenuBar();
+                if (this->firstRun)
+                {
+                    this->firstRun = false;
+                    resizeWindow();
+                }
             }
 
-            if (this->firstRun)
             {
-                this->firstRun = false;
-                resizeWindow();
+                TRACE_SCOPE("MainApp::render");
+                auto mousePos = sf::Mouse::getPosition(this->window);
+                auto mX       = this->relativeToBoardX(mousePos.x);
+                auto mY       = this->relativeToBoardY(mousePos.y);
+                if (this->debugAssist and !this->spectatorGrid and this->boardView.hasMine(mX, mY))
+                    this->window.clear(ALERT_COLOR);
+                else
+                    this->window.clear(BACKGROUND_COLOR);
+
+                if (this->spectatorGrid)
+                    this->window.draw(*this->spectatorGrid, this->boardTransform);
+                else
+                {
+                    AllocationScope allocScope;
+                    this->window.draw(this->boardView, this->boardTransform);
+                    this->hotPathAllocations += allocScope.getCount();
+                }
+                ImGui::SFML::Render(this->window);
             }
 
-            auto mousePos = sf::Mouse::getPosition(this->window);
-            auto mX       = this->relativeToBoardX(mousePos.x);
-            auto mY       = this->relativeToBoardY(mousePos.y);
-            if (this->debugAssist and this->gameBoard.hasMine(mX, mY))
-                this->window.clear(ALERT_COLOR);
-            else
-                this->window.clear(BACKGROUND_COLOR);
-
-            this->window.draw(gameBoard, this->boardTransform);
-            ImGui::SFML::Render(this->window);
-
+            TRACE_SCOPE("MainApp::display");
             this->window.display();
         }
     }
@@ -287,6 +594,21 @@ int main(int argc, char* argv[])
     consoleLog("Working directory: " + std::filesystem::current_path().string());
     consoleLog("-------------------------------");
 
+    // --deltas <file or pipe> at the end streams every change to the board
+    std::vector<std::unique_ptr<DeltaSink>> deltaSinks;
+    if (argc >= 3 and std::string_view {argv[argc - 2]} == "--deltas")
+    {
+        consoleLog("Streaming board deltas to " + std::string {argv[argc - 1]});
+        auto sink = std::make_unique<StreamDeltaSink>(argv[argc - 1]);
+        if (!sink->isOpen())
+        {
+            std::cerr << "Could not open " << argv[argc - 1] << " for board deltas" << std::endl;
+            return EXIT_FAILURE;
+        }
+        deltaSinks.push_back(std::move(sink));
+        argc -= 2;
+    }
+
     if (argc == 4)
     {
         auto width     = std::stoi(argv[1]);
@@ -294,13 +616,13 @@ int main(int argc, char* argv[])
         auto mineCount = std::stoi(argv[3]);
         if (width > 0 and height > 0 and mineCount > 0)
         {
-            MainApp(width, height, mineCount)();
+            MainApp(std::move(deltaSinks), width, height, mineCount)();
 
             return EXIT_SUCCESS;
         }
     }
 
-    MainApp()();
+    MainApp(std::move(deltaSinks))();
 
     return EXIT_SUCCESS;
 }
@@ -1,60 +1,53 @@
 #include "Minesweeper.h"
 
-#include <numeric>
-#include <queue>
+#include "Trace.h"
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
 #include <random>
 #include <ranges>
 
-sf::Sprite TextureManager::getSprite(SpriteType spriteType) const
+sf::IntRect TextureManager::getTextureRect(SpriteType spriteType)
 {
-    sf::Sprite sprite {this->tileset};
     switch (spriteType)
     {
     case SpriteType::COVERED_TILE:
-        sprite.setTextureRect({0, 0, TILE_SIZE, TILE_SIZE});
-        break;
+        return {0, 0, TILE_SIZE, TILE_SIZE};
     case SpriteType::FLAGGED_TILE:
-        sprite.setTextureRect({TILE_SIZE, 0, TILE_SIZE, TILE_SIZE});
-        break;
+        return {TILE_SIZE, 0, TILE_SIZE, TILE_SIZE};
     case SpriteType::INCORRECT_FLAG_TILE:
-        sprite.setTextureRect({3 * TILE_SIZE, TILE_SIZE, TILE_SIZE, TILE_SIZE});
-        break;
+        return {3 * TILE_SIZE, TILE_SIZE, TILE_SIZE, TILE_SIZE};
     case SpriteType::INERT_MINE:
-        sprite.setTextureRect({2 * TILE_SIZE, 0, TILE_SIZE, TILE_SIZE});
-        break;
+        return {2 * TILE_SIZE, 0, TILE_SIZE, TILE_SIZE};
     case SpriteType::DETONATED_MINE:
-        sprite.setTextureRect({3 * TILE_SIZE, 0, TILE_SIZE, TILE_SIZE});
-        break;
+        return {3 * TILE_SIZE, 0, TILE_SIZE, TILE_SIZE};
     case SpriteType::UNCOVERED_0:
-        sprite.setTextureRect({0, TILE_SIZE, TILE_SIZE, TILE_SIZE});
-        break;
+        return {0, TILE_SIZE, TILE_SIZE, TILE_SIZE};
     case SpriteType::UNCOVERED_1:
-        sprite.setTextureRect({TILE_SIZE, TILE_SIZE, TILE_SIZE, TILE_SIZE});
-        break;
+        return {TILE_SIZE, TILE_SIZE, TILE_SIZE, TILE_SIZE};
     case SpriteType::UNCOVERED_2:
-        sprite.setTextureRect({2 * TILE_SIZE, TILE_SIZE, TILE_SIZE, TILE_SIZE});
-        break;
+        return {2 * TILE_SIZE, TILE_SIZE, TILE_SIZE, TILE_SIZE};
     case SpriteType::UNCOVERED_3:
-        sprite.setTextureRect({0, 2 * TILE_SIZE, TILE_SIZE, TILE_SIZE});
-        break;
+        return {0, 2 * TILE_SIZE, TILE_SIZE, TILE_SIZE};
     case SpriteType::UNCOVERED_4:
-        sprite.setTextureRect({TILE_SIZE, 2 * TILE_SIZE, TILE_SIZE, TILE_SIZE});
-        break;
+        return {TILE_SIZE, 2 * TILE_SIZE, TILE_SIZE, TILE_SIZE};
     case SpriteType::UNCOVERED_5:
-        sprite.setTextureRect({2 * TILE_SIZE, 2 * TILE_SIZE, TILE_SIZE, TILE_SIZE});
-        break;
+        return {2 * TILE_SIZE, 2 * TILE_SIZE, TILE_SIZE, TILE_SIZE};
     case SpriteType::UNCOVERED_6:
-        sprite.setTextureRect({0, 3 * TILE_SIZE, TILE_SIZE, TILE_SIZE});
-        break;
+        return {0, 3 * TILE_SIZE, TILE_SIZE, TILE_SIZE};
     case SpriteType::UNCOVERED_7:
-        sprite.setTextureRect({TILE_SIZE, 3 * TILE_SIZE, TILE_SIZE, TILE_SIZE});
-        break;
+        return {TILE_SIZE, 3 * TILE_SIZE, TILE_SIZE, TILE_SIZE};
     case SpriteType::UNCOVERED_8:
-        sprite.setTextureRect({2 * TILE_SIZE, 3 * TILE_SIZE, TILE_SIZE, TILE_SIZE});
-        break;
+        return {2 * TILE_SIZE, 3 * TILE_SIZE, TILE_SIZE, TILE_SIZE};
     }
 
-    return sprite;
+    return {};
+}
+
+sf::Sprite TextureManager::getSprite(SpriteType spriteType) const
+{
+    return sf::Sprite {this->tileset, getTextureRect(spriteType)};
 }
 
 sf::Sprite TextureManager::getSprite(NumberValue digit) const
@@ -100,105 +93,288 @@ sf::Sprite TextureManager::getSprite(NumberValue digit) const
     return sprite;
 }
 
-int32_t GameBoard::getMineNumber(std::tuple<int32_t, int32_t> coords) const
+template<typename Topo>
+void GameBoard::placeMine(int64_t index)
 {
-    auto [x, y]   = coords;
-    int32_t count = 0;
-    for (auto i: std::views::iota(-1, 2))
-        for (auto j: std::views::iota(-1, 2))
-        {
-            if (i == 0 and j == 0)
-                continue;
-            if (this->mineLocation.contains({x + i, y + j}))
-                count++;
-        }
+    this->tiles[index] |= TILE_MINE_BIT;
+    // Border tiles are counted too, they just never get shown
+    Topo::forEachNeighbour(this->getGeometry(), index, [this](int64_t neighbour) { this->tiles[neighbour]++; });
+}
 
-    return count;
+template<typename Topo>
+void GameBoard::removeMine(int64_t index)
+{
+    this->tiles[index] &= ~TILE_MINE_BIT;
+    Topo::forEachNeighbour(this->getGeometry(), index, [this](int64_t neighbour) { this->tiles[neighbour]--; });
 }
 
-int32_t GameBoard::countFlags(int32_t x, int32_t y) const
+template<typename Topo>
+int32_t GameBoard::countFlags(int64_t index) const
 {
     int32_t count = 0;
-    for (auto i: std::views::iota(-1, 2))
-        for (auto j: std::views::iota(-1, 2))
-        {
-            if (i == 0 and j == 0)
-                continue;
-            if (this->isOutOfBounds(x + i, y + j))
-                continue;
-            if (this->getBoardState(x + i, y + j) == TileState::FLAGGED)
-                count++;
-        }
+    Topo::forEachNeighbour(this->getGeometry(), index, [this, &count](int64_t neighbour)
+                           { count += this->getBoardState(neighbour) == TileState::FLAGGED; });
 
     return count;
 }
 
 bool GameBoard::checkWinCon() const
 {
-    uint32_t count = 0;
-    for (auto s: this->boardState)
-        count += s == TileState::COVERED or s == TileState::FLAGGED;
-
-    return count == this->mineLocation.size();
+    TRACE_SCOPE("GameBoard::checkWinCon");
+    return this->numCoveredSafe == 0;
 }
 
 bool GameBoard::checkLoseCon() const
 {
-    for (auto const& [x, y]: this->mineLocation)
-        if (this->getBoardState(x, y) == TileState::UNCOVERED)
-            return true;
+    TRACE_SCOPE("GameBoard::checkLoseCon");
+    return this->mineDetonated;
+}
+
+void GameBoard::checkGameOver()
+{
+    if (this->gameState != GameState::GAME_ONGOING)
+        return;
+
+    if (this->checkLoseCon())
+    {
+        this->gameState  = GameState::GAME_LOST;
+        this->finishTime = this->gameClock.getElapsedTime();
+    }
+    else if (this->checkWinCon())
+    {
+        this->gameState  = GameState::GAME_WON;
+        this->finishTime = this->gameClock.getElapsedTime();
+    }
+
+    // A lost game shows every mine and every wrong flag, neither of which
+    //   listeners have been sent yet. Paged boards are too big to scan, so
+    //   there they only see the mine that was hit.
+    if (this->gameState == GameState::GAME_LOST and this->recordingChanges and !this->tiles.isPaged())
+        for (auto y: std::views::iota(0, this->boardHeight))
+            for (auto index: std::views::iota(this->flatten(0, y), this->flatten(this->boardWidth, y)))
+                if (this->getBoardState(index) == TileState::FLAGGED or
+                    (this->isMine(index) and this->getBoardState(index) == TileState::COVERED))
+                    this->changedTiles.push_back(index);
+
+    // Whatever was left of a reveal no longer matters
+    if (this->gameState != GameState::GAME_ONGOING)
+    {
+        this->fillQueue.clear();
+        this->fillHead = 0;
+    }
+}
+
+int32_t GameBoard::findOpening(int32_t index)
+{
+    // Path halving keeps the trees shallow without recursion
+    while (this->openingParent[index] != index)
+    {
+        this->openingParent[index] = this->openingParent[this->openingParent[index]];
+        index                      = this->openingParent[index];
+    }
+
+    return index;
+}
+
+template<typename Topo>
+void GameBoard::computeBoardValue()
+{
+    if (this->tiles.isPaged())
+    {
+        this->stats.boardValue = 0;
+        return;
+    }
+
+    // Every opening takes one click, and so does every number that does not
+    //   border an opening
+    this->openingParent.assign(this->tiles.size(), -1);
+    for (auto y: std::views::iota(0, this->boardHeight))
+        for (auto index: std::views::iota(this->flatten(0, y), this->flatten(this->boardWidth, y)))
+            if (!this->isMine(index) and this->getMineCount(index) == 0)
+                this->openingParent[index] = static_cast<int32_t>(index);
+
+    int32_t boardValue = 0;
+    for (auto y: std::views::iota(0, this->boardHeight))
+        for (auto index: std::views::iota(this->flatten(0, y), this->flatten(this->boardWidth, y)))
+        {
+            if (this->isMine(index))
+                continue;
+
+            if (this->openingParent[index] < 0)
+            {
+                bool bordersOpening = false;
+                Topo::forEachNeighbour(this->getGeometry(), index, [this, &bordersOpening](int64_t neighbour)
+                                       { bordersOpening |= this->openingParent[neighbour] >= 0; });
+                boardValue += !bordersOpening;
+                continue;
+            }
 
-    return false;
+            // Each union merges two openings, so count one per tile and take
+            //   one back per successful merge
+            boardValue++;
+            Topo::forEachNeighbour(this->getGeometry(), index,
+                                   [this, index, &boardValue](int64_t neighbour)
+                                   {
+                                       if (this->openingParent[neighbour] < 0)
+                                           return;
+                                       auto root          = this->findOpening(static_cast<int32_t>(index));
+                                       auto neighbourRoot = this->findOpening(static_cast<int32_t>(neighbour));
+                                       if (root == neighbourRoot)
+                                           return;
+                                       this->openingParent[std::max(root, neighbourRoot)] = std::min(root, neighbourRoot);
+                                       boardValue--;
+                                   });
+        }
+
+    this->stats.boardValue = boardValue;
 }
 
-void GameBoard::floodFill(int32_t x, int32_t y)
+void GameBoard::queueReveal(int64_t index)
 {
-    std::queue<std::tuple<int32_t, int32_t>> tilesToCheck;
-    if (this->getBoardState(x, y) != TileState::UNCOVERED)
+    if (this->getBoardState(index) != TileState::UNCOVERED)
         return;
-    if (this->mineLocation.contains({x, y}))
+    if (this->isMine(index))
         return;
-    if (this->getMineCount(x, y) != 0)
+    if (this->getMineCount(index) != 0)
         return;
 
-    tilesToCheck.emplace(x, y);
-    while (!tilesToCheck.empty())
+    this->fillQueue.push_back(index);
+}
+
+template<typename Topo>
+void GameBoard::floodFill(int64_t maxTiles)
+{
+    TRACE_SCOPE("GameBoard::floodFill");
+
+    // Processed entries are dropped once they make up half the queue, so it
+    //   only ever holds about twice the frontier
+    constexpr size_t COMPACT_THRESHOLD {4096};
+
+    for (int64_t processed = 0; processed < maxTiles and this->isRevealing(); processed++)
     {
-        auto [tileX, tileY] = tilesToCheck.front();
-        for (auto i: std::views::iota(-1, 2))
-            for (auto j: std::views::iota(-1, 2))
+        auto tile = this->fillQueue[this->fillHead++];
+        Topo::forEachNeighbour(this->getGeometry(), tile,
+                               [this](int64_t neighbour)
+                               {
+                                   // Not opened, not marked -- border tiles are never covered
+                                   if (this->getBoardState(neighbour) == TileState::COVERED)
+                                   {
+                                       this->uncoverTile(neighbour);
+                                       if (this->getMineCount(neighbour) == 0)
+                                           this->fillQueue.push_back(neighbour);
+                                   }
+                               });
+
+        if (this->fillHead >= COMPACT_THRESHOLD and 2 * this->fillHead >= this->fillQueue.size())
+        {
+            this->fillQueue.erase(this->fillQueue.begin(), this->fillQueue.begin() + this->fillHead);
+            this->fillHead = 0;
+        }
+    }
+
+    if (!this->isRevealing())
+    {
+        this->fillQueue.clear();
+        this->fillHead = 0;
+    }
+}
+
+bool GameBoard::advanceReveal(int64_t maxTiles)
+{
+    if (!this->isRevealing())
+        return false;
+
+    this->withTopology([&]<typename Topo>(Topo) { this->floodFill<Topo>(maxTiles); });
+    this->checkGameOver();
+
+    return this->isRevealing();
+}
+
+SpriteType getTileSprite(uint8_t tile, GameState gameState, bool detonated)
+{
+    auto isMine = (tile & TILE_MINE_BIT) != 0;
+    switch (static_cast<TileState>((tile & TILE_STATE_MASK) >> TILE_STATE_SHIFT))
+    {
+    case TileState::COVERED:
+        switch (gameState)
+        {
+        case GameState::GAME_NOT_STARTED:
+        case GameState::GAME_ONGOING:
+            if (tile & TILE_TELEGRAPH_BIT)
+                return SpriteType::UNCOVERED_0;
+            else
+                return SpriteType::COVERED_TILE;
+        case GameState::GAME_WON:
+            return SpriteType::FLAGGED_TILE;
+        case GameState::GAME_LOST:
+            if (isMine)
+                return SpriteType::INERT_MINE;
+            else
+                return SpriteType::COVERED_TILE;
+        }
+        break;
+    case TileState::UNCOVERED:
+        if (isMine)
+        {
+            if (detonated)
+                return SpriteType::DETONATED_MINE;
+            else
+                return SpriteType::INERT_MINE;
+        }
+        else
+            switch (tile & TILE_COUNT_MASK)
             {
-                if (i == 0 and j == 0)
-                    continue;
-                auto nX = tileX + i;
-                auto nY = tileY + j;
-                // Out of bounds
-                if (isOutOfBounds(nX, nY))
-                    continue;
-                // Not opened, not marked
-                if (this->getBoardState(nX, nY) == TileState::COVERED)
-                {
-                    this->setBoardState(nX, nY, TileState::UNCOVERED);
-                    if (this->getMineCount(nX, nY) == 0)
-                        tilesToCheck.emplace(nX, nY);
-                }
+            case 1:
+                return SpriteType::UNCOVERED_1;
+            case 2:
+                return SpriteType::UNCOVERED_2;
+            case 3:
+                return SpriteType::UNCOVERED_3;
+            case 4:
+                return SpriteType::UNCOVERED_4;
+            case 5:
+                return SpriteType::UNCOVERED_5;
+            case 6:
+                return SpriteType::UNCOVERED_6;
+            case 7:
+                return SpriteType::UNCOVERED_7;
+            case 8:
+                return SpriteType::UNCOVERED_8;
+            default:
+                return SpriteType::UNCOVERED_0;
             }
-
-        tilesToCheck.pop();
+        break;
+    case TileState::FLAGGED:
+        switch (gameState)
+        {
+        case GameState::GAME_NOT_STARTED:
+        case GameState::GAME_ONGOING:
+        case GameState::GAME_WON:
+            return SpriteType::FLAGGED_TILE;
+        case GameState::GAME_LOST:
+            if (isMine)
+                return SpriteType::FLAGGED_TILE;
+            else
+                return SpriteType::INCORRECT_FLAG_TILE;
+        }
+        break;
     }
+
+    return SpriteType::COVERED_TILE;
 }
 
-void GameBoard::draw(sf::RenderTarget& target, sf::RenderStates states) const
+void BoardView::draw(sf::RenderTarget& target, sf::RenderStates states) const
 {
+    TRACE_SCOPE("BoardView::draw");
+    auto const& snapshot = *this->snapshot;
+
     // Copy base transform from render state
     sf::Transform baseTransform {states.transform};
 
     // Draw text -- remaining mine
-    int32_t numMineRemaining = this->mineCount;
-    for (auto ts: this->boardState)
-        numMineRemaining -= ts == TileState::FLAGGED;
+    int32_t numMineRemaining = snapshot.mineCount - snapshot.numFlags;
 
-    if (this->gameState == GameState::GAME_WON or numMineRemaining < 0)
+    if (snapshot.gameState == GameState::GAME_WON or numMineRemaining < 0)
         numMineRemaining = 0;
 
     sf::Transform numberTransform {};
@@ -218,23 +394,23 @@ void GameBoard::draw(sf::RenderTarget& target, sf::RenderStates states) const
 
     // Draw text -- timer
     int32_t elapsedTime;
-    switch (this->gameState)
+    switch (snapshot.gameState)
     {
     case GameState::GAME_NOT_STARTED:
     case GameState::GAME_ONGOING:
-        elapsedTime = this->gameClock.getElapsedTime().asMilliseconds();
+        elapsedTime = snapshot.gameClock.getElapsedTime().asMilliseconds();
         break;
     case GameState::GAME_WON:
     case GameState::GAME_LOST:
-        elapsedTime = this->finishTime.asMilliseconds();
+        elapsedTime = snapshot.finishTime.asMilliseconds();
         break;
     }
-    if (!this->clockStarted)
+    if (!snapshot.clockStarted)
         elapsedTime = 0;
 
     numberTransform = sf::Transform {};
     numberTransform.translate(MARGIN, MARGIN)
-        .translate(static_cast<float>(TILE_SIZE) * this->boardWidth, DIGIT_HEIGHT)
+        .translate(static_cast<float>(TILE_SIZE) * snapshot.regionWidth, DIGIT_HEIGHT)
         .scale({MS_SCALE, MS_SCALE})
         .translate(0, -DIGIT_HEIGHT);
     for ([[maybe_unused]] auto i: std::views::iota(0, 3))
@@ -253,7 +429,7 @@ void GameBoard::draw(sf::RenderTarget& target, sf::RenderStates states) const
     numberTransform = sf::Transform {};
     numberTransform.translate(MARGIN, MARGIN)
         .translate(-3 * DIGIT_WIDTH * MS_SCALE, 0)
-        .translate(static_cast<float>(TILE_SIZE) * this->boardWidth, 0);
+        .translate(static_cast<float>(TILE_SIZE) * snapshot.regionWidth, 0);
     for ([[maybe_unused]] auto i: std::views::iota(0, 3))
     {
         auto numVal = NumberValue(elapsedTime % 10);
@@ -267,103 +443,45 @@ void GameBoard::draw(sf::RenderTarget& target, sf::RenderStates states) const
         elapsedTime /= 10;
     }
 
-    // Draw board
-    for (auto y: std::views::iota(0, this->boardHeight))
-        for (auto x: std::views::iota(0, this->boardWidth))
+    // Draw board -- only the tiles inside the view
+    sf::Transform boardTransform {baseTransform};
+    boardTransform.translate(MARGIN, 2 * MARGIN + DIGIT_HEIGHT);
+
+    auto const& view = target.getView();
+    auto visible     = boardTransform.getInverse().transformRect(
+        {view.getCenter() - view.getSize() / 2.0f, view.getSize()});
+    auto toTile      = [](float pos, int32_t size)
+    {
+        return static_cast<int32_t>(std::clamp(std::floor(pos / TILE_SIZE), 0.0f, static_cast<float>(size)));
+    };
+    auto firstX = toTile(visible.left - TILE_SIZE, snapshot.regionWidth);
+    auto lastX  = toTile(visible.left + visible.width + TILE_SIZE, snapshot.regionWidth);
+    auto firstY = toTile(visible.top - TILE_SIZE, snapshot.regionHeight);
+    auto lastY  = toTile(visible.top + visible.height + TILE_SIZE, snapshot.regionHeight);
+
+    auto hexShift = snapshot.topology == Topology::HEXAGONAL ? TILE_SIZE / 2 : 0;
+    for (auto y: std::views::iota(firstY, lastY))
+        for (auto x: std::views::iota(firstX, lastX))
         {
-            sf::Sprite sprite;
-            switch (this->getBoardState(x, y))
-            {
-            case TileState::COVERED:
-                switch (this->gameState)
-                {
-                case GameState::GAME_NOT_STARTED:
-                case GameState::GAME_ONGOING:
-                    if (this->telegraphedTile.contains({x, y}))
-                        sprite = this->textureMgr.getSprite(SpriteType::UNCOVERED_0);
-                    else
-                        sprite = this->textureMgr.getSprite(SpriteType::COVERED_TILE);
-                    break;
-                case GameState::GAME_WON:
-                    sprite = this->textureMgr.getSprite(SpriteType::FLAGGED_TILE);
-                    break;
-                case GameState::GAME_LOST:
-                    if (this->mineLocation.contains({x, y}))
-                        sprite = this->textureMgr.getSprite(SpriteType::INERT_MINE);
-                    else
-                        sprite = this->textureMgr.getSprite(SpriteType::COVERED_TILE);
-                    break;
-                }
-                break;
-            case TileState::UNCOVERED:
-                if (this->mineLocation.contains({x, y}))
-                {
-                    if (this->lastClickedCoords == std::tie(x, y))
-                        sprite = this->textureMgr.getSprite(SpriteType::DETONATED_MINE);
-                    else
-                        sprite = this->textureMgr.getSprite(SpriteType::INERT_MINE);
-                }
-                else
-                    switch (this->getMineCount(x, y))
-                    {
-                    case 1:
-                        sprite = this->textureMgr.getSprite(SpriteType::UNCOVERED_1);
-                        break;
-                    case 2:
-                        sprite = this->textureMgr.getSprite(SpriteType::UNCOVERED_2);
-                        break;
-                    case 3:
-                        sprite = this->textureMgr.getSprite(SpriteType::UNCOVERED_3);
-                        break;
-                    case 4:
-                        sprite = this->textureMgr.getSprite(SpriteType::UNCOVERED_4);
-                        break;
-                    case 5:
-                        sprite = this->textureMgr.getSprite(SpriteType::UNCOVERED_5);
-                        break;
-                    case 6:
-                        sprite = this->textureMgr.getSprite(SpriteType::UNCOVERED_6);
-                        break;
-                    case 7:
-                        sprite = this->textureMgr.getSprite(SpriteType::UNCOVERED_7);
-                        break;
-                    case 8:
-                        sprite = this->textureMgr.getSprite(SpriteType::UNCOVERED_8);
-                        break;
-                    default:
-                        sprite = this->textureMgr.getSprite(SpriteType::UNCOVERED_0);
-                        break;
-                    }
-                break;
-            case TileState::FLAGGED:
-                switch (this->gameState)
-                {
-                case GameState::GAME_NOT_STARTED:
-                case GameState::GAME_ONGOING:
-                case GameState::GAME_WON:
-                    sprite = this->textureMgr.getSprite(SpriteType::FLAGGED_TILE);
-                    break;
-                case GameState::GAME_LOST:
-                    if (this->mineLocation.contains({x, y}))
-                        sprite = this->textureMgr.getSprite(SpriteType::FLAGGED_TILE);
-                    else
-                        sprite = this->textureMgr.getSprite(SpriteType::INCORRECT_FLAG_TILE);
-                    break;
-                }
-                break;
-            }
+            auto tile      = snapshot.tiles[x + y * static_cast<int64_t>(snapshot.regionWidth)];
+            auto boardX    = snapshot.regionX + x;
+            auto boardY    = snapshot.regionY + y;
+            auto detonated = snapshot.lastClickedX == boardX and snapshot.lastClickedY == boardY;
+            auto sprite    = this->textureMgr.getSprite(getTileSprite(tile, snapshot.gameState, detonated));
 
+            // Rows are shifted by where they are on the board, not in the region
             sf::Transform translate;
+            translate.translate(x * TILE_SIZE + (boardY % 2) * hexShift, y * TILE_SIZE);
             // Transform chains are right to left!!
-            translate.translate(MARGIN, 2 * MARGIN + DIGIT_HEIGHT).translate(x * TILE_SIZE, y * TILE_SIZE);
-            states.transform = baseTransform * translate;
+            states.transform = boardTransform * translate;
 
             target.draw(sprite, states);
         }
 }
 
-void GameBoard::initialize(int32_t boardWidth, int32_t boardHeight, int32_t mineCount)
+void GameBoard::initialize(int32_t boardWidth, int32_t boardHeight, int32_t mineCount, Topology topology)
 {
+    TRACE_SCOPE("GameBoard::initialize");
     consoleLog("Initializing game board...");
     consoleLog("Board width = " + std::to_string(boardWidth));
     consoleLog("Board height = " + std::to_string(boardHeight));
@@ -371,43 +489,115 @@ void GameBoard::initialize(int32_t boardWidth, int32_t boardHeight, int32_t mine
     this->boardWidth   = boardWidth;
     this->boardHeight  = boardHeight;
     this->mineCount    = mineCount;
-    this->numTiles     = boardWidth * boardHeight;
+    this->numTiles     = static_cast<int64_t>(boardWidth) * boardHeight;
+    this->stride       = boardWidth + 2;
+    this->topology     = topology;
     this->gameState    = GameState::GAME_NOT_STARTED;
     this->clockStarted = false;
-    this->mineLocation.clear();
-    this->mineCounts.clear();
-    this->boardState.clear();
 
     if (mineCount >= this->numTiles)
-        this->mineCount = this->numTiles - 1;
+        this->mineCount = static_cast<int32_t>(this->numTiles - 1);
+    // Tiles would neighbour themselves on a torus this small
+    if (topology == Topology::TORUS and (boardWidth < 3 or boardHeight < 3))
+        this->topology = Topology::SQUARE;
 
-    std::vector<uint32_t> possibleLocations(this->numTiles);
-    std::iota(possibleLocations.begin(), possibleLocations.end(), 0);
+    this->numCoveredSafe = this->numTiles - this->mineCount;
+    this->numFlags       = 0;
+    this->mineDetonated  = false;
 
-    consoleLog("Placing mines...");
-    std::mt19937 rng {std::random_device {}()};
-    std::shuffle(possibleLocations.begin(), possibleLocations.end(), rng);
-    for (int i = 0; i < mineCount; ++i)
-        this->mineLocation.emplace(this->deflatten(possibleLocations[i]));
+    consoleLog("Populating board state...");
+    this->tiles.assign(static_cast<int64_t>(this->stride) * (boardHeight + 2), packTileState(TileState::UNCOVERED),
+                       MAX_RESIDENT_TILE_BYTES);
+    if (this->tiles.isPaged())
+        consoleLog("Board is paged to disk");
+    for (auto y: std::views::iota(0, boardHeight))
+        for (auto index: std::views::iota(this->flatten(0, y), this->flatten(boardWidth, y)))
+            this->tiles[index] = packTileState(TileState::COVERED);
+
+    this->fillQueue.clear();
+    this->fillQueue.reserve(std::min<int64_t>(this->numTiles, 1 << 16));
+    this->fillHead       = 0;
+    this->numTelegraphed = 0;
+    this->changedTiles.clear();
 
-    consoleLog("Calculating tile contents...");
-    this->mineCounts.resize(numTiles, 0);
-    for (int i = 0; i < this->numTiles; ++i)
-        this->mineCounts[i] = this->getMineNumber(this->deflatten(i));
+    consoleLog("Placing mines...");
+    std::mt19937_64 rng {std::random_device {}()};
+    std::uniform_int_distribution<int64_t> randomTile {0, this->numTiles - 1};
+    this->withTopology(
+        [&]<typename Topo>(Topo)
+        {
+            // Random picks on a paged board would page in a chunk for nearly
+            //   every mine, so it is filled in storage order instead: each tile
+            //   is a mine with the odds of mines left over tiles left, which
+            //   still makes every layout equally likely. A mine's neighbours
+            //   are all in the rows either side, so the counts are built in
+            //   the same pass and each chunk is paged in about once.
+            if (this->tiles.isPaged())
+            {
+                int64_t minesLeft = this->mineCount;
+                for (auto tile: std::views::iota(int64_t {0}, this->numTiles))
+                {
+                    if (minesLeft == 0)
+                        break;
+                    if (std::uniform_int_distribution<int64_t> {0, this->numTiles - tile - 1}(rng) >= minesLeft)
+                        continue;
+                    this->placeMine<Topo>(this->flattenTile(tile));
+                    minesLeft--;
+                }
+            }
+            // Rejection sampling needs no memory beyond the board itself. Dense
+            //   boards start out full of mines and pick the safe tiles instead,
+            //   so on average no tile takes more than two tries.
+            else if (int64_t {this->mineCount} * 2 <= this->numTiles)
+            {
+                for (int32_t placed = 0; placed < this->mineCount;)
+                {
+                    auto index = this->flattenTile(randomTile(rng));
+                    if (this->isMine(index))
+                        continue;
+                    this->placeMine<Topo>(index);
+                    placed++;
+                }
+            }
+            else
+            {
+                for (auto tile: std::views::iota(int64_t {0}, this->numTiles))
+                    this->placeMine<Topo>(this->flattenTile(tile));
+                for (auto remaining = this->numTiles; remaining > this->mineCount;)
+                {
+                    auto index = this->flattenTile(randomTile(rng));
+                    if (!this->isMine(index))
+                        continue;
+                    this->removeMine<Topo>(index);
+                    remaining--;
+                }
+            }
 
-    consoleLog("Populating board state...");
-    this->boardState.resize(this->numTiles, TileState::COVERED);
+            consoleLog("Labelling openings...");
+            this->stats = GameStats {};
+            this->computeBoardValue<Topo>();
+        });
 }
 
 void GameBoard::interact(float x, float y, sf::Mouse::Button mouseBtn)
 {
+    TRACE_SCOPE("GameBoard::interact");
     if (mouseBtn != sf::Mouse::Button::Left and mouseBtn != sf::Mouse::Button::Right)
         return;
+    x -= getRowShift(this->topology, y);
     if (this->isOutOfBounds(x, y))
         return;
 
-    this->lastClickedCoords = std::make_tuple(x, y);
-    switch (this->getBoardState(x, y))
+    auto index = this->flatten(x, y);
+    this->withTopology([&]<typename Topo>(Topo) { this->interactTile<Topo>(index, mouseBtn); });
+}
+
+template<typename Topo>
+void GameBoard::interactTile(int64_t index, sf::Mouse::Button mouseBtn)
+{
+    this->lastClickedIndex = index;
+    this->stats.clicks++;
+    switch (this->getBoardState(index))
     {
     case TileState::COVERED:
         if (!this->clockStarted)
@@ -418,53 +608,50 @@ void GameBoard::interact(float x, float y, sf::Mouse::Button mouseBtn)
 
         if (mouseBtn == sf::Mouse::Button::Left)
         {
-            this->setBoardState(x, y, TileState::UNCOVERED);
             // Losing on first turn is not allowed
-            if (this->gameState == GameState::GAME_NOT_STARTED and this->mineLocation.contains(this->lastClickedCoords))
+            if (this->gameState == GameState::GAME_NOT_STARTED and this->isMine(index))
             {
                 consoleLog("Moving mine...");
-                this->mineLocation.erase(this->lastClickedCoords);
-                for (auto i: std::views::iota(0, this->numTiles))
+                this->removeMine<Topo>(index);
+                for (auto i: std::views::iota(int64_t {0}, this->numTiles))
                 {
-                    if (this->mineLocation.contains(this->deflatten(i)))
+                    auto target = this->flattenTile(i);
+                    if (this->isMine(target) or target == index)
                         continue;
-                    if (this->deflatten(i) == this->lastClickedCoords)
-                        continue;
-                    this->mineLocation.emplace(this->deflatten(i));
+                    this->placeMine<Topo>(target);
                     break;
                 }
-                for (int i = 0; i < this->numTiles; ++i)
-                    this->mineCounts[i] = this->getMineNumber(this->deflatten(i));
+                this->computeBoardValue<Topo>();
             }
+            this->uncoverTile(index);
             this->gameState = GameState::GAME_ONGOING;
         }
         else
-            this->setBoardState(x, y, TileState::FLAGGED);
+        {
+            this->setBoardState(index, TileState::FLAGGED);
+            this->numFlags++;
+        }
         break;
     case TileState::UNCOVERED:
         if (mouseBtn == sf::Mouse::Button::Left)
         {
-            if (this->getMineCount(x, y) != this->countFlags(x, y))
+            if (this->getMineCount(index) != this->countFlags<Topo>(index))
                 return;
 
-            for (auto i: std::views::iota(-1, 2))
-                for (auto j: std::views::iota(-1, 2))
-                {
-                    if (i == 0 and j == 0)
-                        continue;
-                    auto nX = x + i;
-                    auto nY = y + j;
-                    // Out of bounds
-                    if (this->isOutOfBounds(nX, nY))
-                        continue;
-                    // Not opened, not marked
-                    if (this->getBoardState(nX, nY) == TileState::COVERED)
-                    {
-                        this->setBoardState(nX, nY, TileState::UNCOVERED);
-                        if (this->getMineCount(nX, nY) == 0)
-                            this->floodFill(nX, nY);
-                    }
-                }
+            bool revealed = false;
+            Topo::forEachNeighbour(this->getGeometry(), index,
+                                   [this, &revealed](int64_t neighbour)
+                                   {
+                                       // Not opened, not marked
+                                       if (this->getBoardState(neighbour) == TileState::COVERED)
+                                       {
+                                           this->uncoverTile(neighbour);
+                                           this->queueReveal(neighbour);
+                                           revealed = true;
+                                       }
+                                   });
+            if (!revealed)
+                return;
         }
         else
             return;
@@ -473,50 +660,50 @@ void GameBoard::interact(float x, float y, sf::Mouse::Button mouseBtn)
         if (mouseBtn == sf::Mouse::Button::Left)
             return;
         else
-            this->setBoardState(x, y, TileState::COVERED);
+        {
+            this->setBoardState(index, TileState::COVERED);
+            this->numFlags--;
+        }
         break;
     }
 
-    this->floodFill(x, y);
-
-    if (this->checkLoseCon())
-    {
-        this->gameState  = GameState::GAME_LOST;
-        this->finishTime = this->gameClock.getElapsedTime();
-    }
-    else if (this->checkWinCon())
-    {
-        this->gameState  = GameState::GAME_WON;
-        this->finishTime = this->gameClock.getElapsedTime();
-    }
+    this->stats.effectiveClicks++;
+    this->queueReveal(index);
+    this->checkGameOver();
 }
 
 void GameBoard::telegraph(float x, float y)
 {
+    TRACE_SCOPE("GameBoard::telegraph");
+    x -= getRowShift(this->topology, y);
     if (this->isOutOfBounds(x, y))
         return;
 
+    auto index = this->flatten(x, y);
     this->clearTelegraph();
-    switch (this->getBoardState(x, y))
+    this->withTopology([&]<typename Topo>(Topo) { this->telegraphTile<Topo>(index); });
+}
+
+template<typename Topo>
+void GameBoard::telegraphTile(int64_t index)
+{
+    switch (this->getBoardState(index))
     {
     case TileState::COVERED:
-        this->telegraphedTile.emplace(x, y);
+        this->tiles[index] |= TILE_TELEGRAPH_BIT;
+        this->telegraphedTiles[this->numTelegraphed++] = index;
         break;
     case TileState::UNCOVERED:
-        for (auto i: std::views::iota(-1, 2))
-            for (auto j: std::views::iota(-1, 2))
-            {
-                if (i == 0 and j == 0)
-                    continue;
-                auto nX = x + i;
-                auto nY = y + j;
-                // Out of bounds
-                if (this->isOutOfBounds(nX, nY))
-                    continue;
-                // Not opened, not marked
-                if (this->getBoardState(nX, nY) == TileState::COVERED)
-                    this->telegraphedTile.emplace(nX, nY);
-            }
+        Topo::forEachNeighbour(this->getGeometry(), index,
+                               [this](int64_t neighbour)
+                               {
+                                   // Not opened, not marked
+                                   if (this->getBoardState(neighbour) == TileState::COVERED)
+                                   {
+                                       this->tiles[neighbour] |= TILE_TELEGRAPH_BIT;
+                                       this->telegraphedTiles[this->numTelegraphed++] = neighbour;
+                                   }
+                               });
         break;
     case TileState::FLAGGED:
         break;
@@ -525,5 +712,272 @@ void GameBoard::telegraph(float x, float y)
 
 void GameBoard::clearTelegraph()
 {
-    this->telegraphedTile.clear();
+    for (auto i: std::views::iota(0, this->numTelegraphed))
+        this->tiles[this->telegraphedTiles[i]] &= ~TILE_TELEGRAPH_BIT;
+    this->numTelegraphed = 0;
+}
+
+void GameBoard::publish(BoardSnapshot& snapshot, int32_t originX, int32_t originY) const
+{
+    TRACE_SCOPE("GameBoard::publish");
+    snapshot.boardWidth   = this->boardWidth;
+    snapshot.boardHeight  = this->boardHeight;
+    snapshot.mineCount    = this->mineCount;
+    snapshot.topology     = this->topology;
+    snapshot.gameState    = this->gameState;
+    snapshot.clockStarted = this->clockStarted;
+    snapshot.gameClock    = this->gameClock;
+    snapshot.finishTime   = this->finishTime;
+    snapshot.numFlags     = this->numFlags;
+    snapshot.stats        = this->stats;
+
+    snapshot.lastClickedX = -1;
+    snapshot.lastClickedY = -1;
+    if (this->lastClickedIndex >= 0)
+    {
+        snapshot.lastClickedX = static_cast<int32_t>(this->lastClickedIndex % this->stride) - 1;
+        snapshot.lastClickedY = static_cast<int32_t>(this->lastClickedIndex / this->stride) - 1;
+    }
+
+    // Copying only the region keeps snapshots of paged boards within the
+    //   tile cache, and the vector keeps its capacity between publishes
+    snapshot.regionWidth  = std::min(this->boardWidth, MAX_SNAPSHOT_SIDE);
+    snapshot.regionHeight = std::min(this->boardHeight, MAX_SNAPSHOT_SIDE);
+    snapshot.regionX      = std::clamp(originX, 0, this->boardWidth - snapshot.regionWidth);
+    snapshot.regionY      = std::clamp(originY, 0, this->boardHeight - snapshot.regionHeight);
+    snapshot.tiles.resize(static_cast<size_t>(snapshot.regionWidth) * snapshot.regionHeight);
+
+    auto firstX = snapshot.regionX;
+    auto lastX  = snapshot.regionX + snapshot.regionWidth;
+    auto firstY = snapshot.regionY;
+    auto lastY  = snapshot.regionY + snapshot.regionHeight;
+
+    auto out = snapshot.tiles.begin();
+    for (auto y: std::views::iota(firstY, lastY))
+        for (auto index: std::views::iota(this->flatten(firstX, y), this->flatten(lastX, y)))
+            *out++ = this->tiles[index];
+
+    if (this->tiles.isPaged())
+        this->prefetchAround(firstX, firstY, lastX, lastY);
+}
+
+void GameBoard::prefetchAround(int32_t firstX, int32_t firstY, int32_t lastX, int32_t lastY) const
+{
+    // The region itself has just been paged in by the copy, so only the tiles
+    //   one pan away need reading: the sides first, as they mostly share
+    //   chunks with the region, then rows outward above and below
+    auto leftX  = std::max(firstX - PAN_STEP, 0);
+    auto rightX = std::min(lastX + PAN_STEP, this->boardWidth);
+    for (auto y: std::views::iota(firstY, lastY))
+        if (!this->tiles.prefetch(this->flatten(leftX, y), this->flatten(firstX, y)) or
+            !this->tiles.prefetch(this->flatten(lastX, y), this->flatten(rightX, y)))
+            return;
+
+    for (auto distance: std::views::iota(1, PAN_STEP + 1))
+    {
+        auto above = firstY - distance;
+        auto below = lastY - 1 + distance;
+        if (above < 0 and below >= this->boardHeight)
+            return;
+        if (above >= 0 and !this->tiles.prefetch(this->flatten(leftX, above), this->flatten(rightX, above)))
+            return;
+        if (below < this->boardHeight and
+            !this->tiles.prefetch(this->flatten(leftX, below), this->flatten(rightX, below)))
+            return;
+    }
+}
+
+void GameBoard::setRecordingChanges(bool recording)
+{
+    this->recordingChanges = recording;
+    this->changedTiles.clear();
+    if (recording)
+        this->changedTiles.reserve(std::min<int64_t>(this->numTiles, 1 << 16));
+}
+
+bool GameBoard::takeDelta(BoardDelta& delta)
+{
+    TRACE_SCOPE("GameBoard::takeDelta");
+    delta.boardWidth  = this->boardWidth;
+    delta.boardHeight = this->boardHeight;
+    delta.mineCount   = this->mineCount;
+    delta.topology    = this->topology;
+    delta.gameState   = this->gameState;
+    delta.runs.clear();
+    delta.tiles.clear();
+
+    auto toTile = [this](int64_t index)
+    {
+        return (index % this->stride - 1) + (index / this->stride - 1) * static_cast<int64_t>(this->boardWidth);
+    };
+    delta.lastClicked = this->lastClickedIndex >= 0 ? toTile(this->lastClickedIndex) : -1;
+
+    // Fills record tiles in the order they reach them, and a tile can be
+    //   recorded more than once in a step. Unless they are spread very thinly,
+    //   a bitmap over their range puts them in order and drops duplicates in
+    //   one pass, which is much cheaper than sorting a big step. The bitmap
+    //   never takes more than 128 bytes per changed tile.
+    if (!this->changedTiles.empty())
+    {
+        auto [lowest, highest] = std::ranges::minmax(this->changedTiles);
+        auto range             = highest - lowest + 1;
+        if (range <= 1024 * static_cast<int64_t>(this->changedTiles.size()))
+        {
+            this->changedBitmap.assign((range + 63) / 64, 0);
+            for (auto index: this->changedTiles)
+                this->changedBitmap[(index - lowest) / 64] |= uint64_t {1} << ((index - lowest) % 64);
+
+            this->changedTiles.clear();
+            for (size_t word = 0; word < this->changedBitmap.size(); word++)
+                for (auto bits = this->changedBitmap[word]; bits; bits &= bits - 1)
+                    this->changedTiles.push_back(lowest + static_cast<int64_t>(word) * 64 + std::countr_zero(bits));
+        }
+        else
+        {
+            std::ranges::sort(this->changedTiles);
+            auto duplicates = std::ranges::unique(this->changedTiles);
+            this->changedTiles.erase(duplicates.begin(), duplicates.end());
+        }
+    }
+
+    for (auto index: this->changedTiles)
+    {
+        auto tile = toTile(index);
+        if (!delta.runs.empty() and delta.runs.back().first + delta.runs.back().length == tile)
+            delta.runs.back().length++;
+        else
+            delta.runs.push_back({tile, 1});
+        auto value = static_cast<uint8_t>(this->tiles[index] & ~TILE_TELEGRAPH_BIT);
+        if (this->gameState != GameState::GAME_LOST and this->getBoardState(index) != TileState::UNCOVERED)
+            value &= TILE_STATE_MASK;
+        delta.tiles.push_back(value);
+    }
+
+    this->changedTiles.clear();
+    return !delta.runs.empty();
+}
+
+bool GameBoard::getEndgamePosition(EndgamePosition& position) const
+{
+    // The player can work out how many safe tiles are left from the mine
+    //   counter, so gating on it gives nothing away
+    if (this->gameState != GameState::GAME_ONGOING or this->tiles.isPaged() or this->isRevealing() or
+        this->numCoveredSafe > MAX_ENDGAME_TILES)
+        return false;
+
+    TRACE_SCOPE("GameBoard::getEndgamePosition");
+
+    // Gathered in index order, so they can be looked up by binary search
+    std::vector<int64_t> covered;
+    for (auto y: std::views::iota(0, this->boardHeight))
+        for (auto index: std::views::iota(this->flatten(0, y), this->flatten(this->boardWidth, y)))
+            if (this->getBoardState(index) != TileState::UNCOVERED)
+                covered.push_back(index);
+
+    auto find = [&covered](int64_t index) -> int64_t
+    {
+        auto found = std::ranges::lower_bound(covered, index);
+        return found != covered.end() and *found == index ? found - covered.begin() : -1;
+    };
+
+    return this->withTopology(
+        [&]<typename Topo>(Topo)
+        {
+            // Every uncovered number next to a covered tile, zeroes included,
+            //   since flags can keep a zero from opening its neighbours. The
+            //   border is left out as the player never sees its counts.
+            std::vector<int64_t> numbers;
+            for (auto index: covered)
+            {
+                Topo::forEachNeighbour(this->getGeometry(), index,
+                                       [&](int64_t neighbour)
+                                       {
+                                           auto x = static_cast<int32_t>(neighbour % this->stride) - 1;
+                                           auto y = static_cast<int32_t>(neighbour / this->stride) - 1;
+                                           if (!this->isOutOfBounds(x, y) and
+                                               this->getBoardState(neighbour) == TileState::UNCOVERED)
+                                               numbers.push_back(neighbour);
+                                       });
+            }
+            std::ranges::sort(numbers);
+            auto [last, end] = std::ranges::unique(numbers);
+            numbers.erase(last, end);
+
+            // An Expert endgame still has all 99 mines covered, but most of
+            //   them are given away by a number with no other covered tiles
+            //   around it. Those are set aside so only the open question is
+            //   left for the solver.
+            std::vector<uint8_t> knownMine(covered.size(), 0);
+            for (auto changed = true; changed;)
+            {
+                changed = false;
+                for (auto index: numbers)
+                {
+                    int32_t unknown = 0;
+                    int32_t known   = 0;
+                    Topo::forEachNeighbour(this->getGeometry(), index,
+                                           [&](int64_t neighbour)
+                                           {
+                                               if (auto tile = find(neighbour); tile >= 0)
+                                                   knownMine[tile] ? known++ : unknown++;
+                                           });
+                    if (unknown == 0 or this->getMineCount(index) - known != unknown)
+                        continue;
+
+                    Topo::forEachNeighbour(this->getGeometry(), index,
+                                           [&](int64_t neighbour)
+                                           {
+                                               if (auto tile = find(neighbour); tile >= 0)
+                                                   knownMine[tile] = 1;
+                                           });
+                    changed = true;
+                }
+            }
+
+            auto numKnown = static_cast<int32_t>(std::ranges::count(knownMine, 1));
+            if (static_cast<int64_t>(covered.size()) - numKnown > MAX_ENDGAME_TILES)
+                return false;
+
+            position.minesLeft = this->mineCount - numKnown;
+            position.tiles.clear();
+            position.constraints.clear();
+
+            std::vector<int32_t> bits(covered.size(), -1);
+            for (size_t i = 0; i < covered.size(); i++)
+            {
+                if (knownMine[i])
+                    continue;
+                bits[i] = static_cast<int32_t>(position.tiles.size());
+                position.tiles.push_back({static_cast<int32_t>(covered[i] % this->stride) - 1,
+                                          static_cast<int32_t>(covered[i] / this->stride) - 1, 0});
+            }
+
+            auto bitOf = [&](int64_t index) -> uint64_t
+            {
+                auto tile = find(index);
+                return tile < 0 or bits[tile] < 0 ? 0 : uint64_t {1} << bits[tile];
+            };
+
+            for (size_t i = 0; i < covered.size(); i++)
+                if (bits[i] >= 0)
+                    Topo::forEachNeighbour(this->getGeometry(), covered[i], [&](int64_t neighbour)
+                                           { position.tiles[bits[i]].neighbours |= bitOf(neighbour); });
+
+            for (auto index: numbers)
+            {
+                uint64_t around = 0;
+                int32_t known   = 0;
+                Topo::forEachNeighbour(this->getGeometry(), index,
+                                       [&](int64_t neighbour)
+                                       {
+                                           around |= bitOf(neighbour);
+                                           if (auto tile = find(neighbour); tile >= 0 and knownMine[tile])
+                                               known++;
+                                       });
+                if (around)
+                    position.constraints.push_back({around, this->getMineCount(index) - known});
+            }
+
+            return true;
+        });
 }
@@ -1,12 +1,16 @@
 #pragma once
 
+#include <array>
 #include <cstdint>
 #include <iostream>
-#include <set>
 #include <vector>
 
 #include <SFML/Graphics.hpp>
 
+#include "EndgameSolver.h"
+#include "TileStorage.h"
+#include "Topology.h"
+
 constexpr uint32_t TILE_SIZE {64};
 
 constexpr int32_t DIGIT_WIDTH {47};
@@ -15,6 +19,16 @@ constexpr float MS_SCALE {0.5};
 
 constexpr uint32_t MARGIN {25};
 
+// Boards bigger than this are paged out to disk instead of held in memory
+constexpr int64_t MAX_RESIDENT_TILE_BYTES {int64_t {256} << 20};
+
+// Snapshots of boards larger than this in either direction only carry a
+//   region this big, wherever the viewport has been moved to
+constexpr int32_t MAX_SNAPSHOT_SIDE {2048};
+// Tiles the viewport moves by when panned. Paged boards read this far around
+//   the region ahead of time, so one pan never waits on the disk.
+constexpr int32_t PAN_STEP {MAX_SNAPSHOT_SIDE / 4};
+
 enum class TileState : uint8_t
 {
     COVERED,
@@ -22,6 +36,22 @@ enum class TileState : uint8_t
     FLAGGED,
 };
 
+// Every tile is packed into a single byte:
+//   bits 0-3 -- number of adjacent mines
+//   bit 4    -- tile holds a mine
+//   bits 5-6 -- TileState
+//   bit 7    -- tile is telegraphed (drawn pressed while LMB is held)
+constexpr uint8_t TILE_COUNT_MASK {0x0F};
+constexpr uint8_t TILE_MINE_BIT {0x10};
+constexpr uint8_t TILE_STATE_SHIFT {5};
+constexpr uint8_t TILE_STATE_MASK {0x03 << TILE_STATE_SHIFT};
+constexpr uint8_t TILE_TELEGRAPH_BIT {0x80};
+
+constexpr uint8_t packTileState(TileState state)
+{
+    return static_cast<uint8_t>(state) << TILE_STATE_SHIFT;
+}
+
 enum class GameState : uint8_t
 {
     GAME_NOT_STARTED,
@@ -30,6 +60,20 @@ enum class GameState : uint8_t
     GAME_LOST,
 };
 
+struct GameStats
+{
+    // 3BV -- the minimum number of clicks needed to clear the board
+    int32_t boardValue {0};
+    int32_t clicks {0};
+    // Clicks that changed the state of at least one tile
+    int32_t effectiveClicks {0};
+
+    inline float getEfficiency() const
+    {
+        return this->clicks == 0 ? 0.0f : 100.0f * this->boardValue / this->clicks;
+    }
+};
+
 enum class SpriteType : uint8_t
 {
     COVERED_TILE,
@@ -63,6 +107,15 @@ enum class NumberValue : uint8_t
     PERIOD,
 };
 
+// Hexagonal boards draw odd rows shifted right by half a tile
+inline float getRowShift(Topology topology, float y)
+{
+    if (topology != Topology::HEXAGONAL or y < 0)
+        return 0.0f;
+
+    return static_cast<int32_t>(y) % 2 == 1 ? 0.5f : 0.0f;
+}
+
 inline void consoleLog(std::string_view message)
 {
 #ifdef DEBUG
@@ -70,17 +123,18 @@ inline void consoleLog(std::string_view message)
 #endif
 }
 
+// Both textures are decoded once and shared by everything that draws tiles
 class TextureManager
 {
 private:
     sf::Texture tileset;
     sf::Texture numbers;
 
-public:
     TextureManager()
     {
         consoleLog("Initializing texture manager...");
         this->tileset.setSmooth(true);
+        this->loadTextures();
     }
 
     void loadTextures()
@@ -90,60 +144,196 @@ public:
         this->numbers.loadFromMemory(minesweeper_numbers.data(), minesweeper_numbers.size());
     }
 
+public:
+    TextureManager(TextureManager const&) = delete;
+    void operator=(TextureManager const&) = delete;
+
+    static auto& getInstance()
+    {
+        static TextureManager instance;
+
+        return instance;
+    }
+
+    // Every tile sprite lives in this one texture, so any number of tiles can
+    //   be drawn with a single vertex array
+    inline auto const& getTileset() const
+    {
+        return this->tileset;
+    }
+
+    // Where a sprite sits in the tileset, which needs no texture, so it works
+    //   as well for a CPU copy of the tileset
+    static sf::IntRect getTextureRect(SpriteType spriteType);
     sf::Sprite getSprite(SpriteType spriteType) const;
     sf::Sprite getSprite(NumberValue digit) const;
 };
 
-class GameBoard : public sf::Drawable
+// Everything needed to draw a board, copied out by the simulation thread and
+//   never modified once published. Tiles are packed the same way as on the
+//   board, row by row, without the border.
+struct BoardSnapshot
+{
+    uint64_t version {0};
+
+    int32_t boardWidth {0};
+    int32_t boardHeight {0};
+    int32_t mineCount {0};
+    Topology topology {Topology::SQUARE};
+
+    GameState gameState {GameState::GAME_NOT_STARTED};
+    bool clockStarted {false};
+    sf::Clock gameClock;
+    sf::Time finishTime;
+
+    int32_t numFlags {0};
+    GameStats stats;
+    // Allocations the simulation thread made while handling input
+    uint64_t hotPathAllocations {0};
+
+    // Tiles holds this region of the board, which is the whole board unless
+    //   it is bigger than MAX_SNAPSHOT_SIDE. The last click is in board tiles.
+    int32_t regionX {0};
+    int32_t regionY {0};
+    int32_t regionWidth {0};
+    int32_t regionHeight {0};
+    int32_t lastClickedX {-1};
+    int32_t lastClickedY {-1};
+    std::vector<uint8_t> tiles;
+
+    // Best play from the last position analysed while the game was ongoing
+    EndgameResult endgame;
+};
+
+// What one move changed on a board, or one step of a reveal. Tiles are
+//   numbered row by row without the border, and the changed ones are grouped
+//   into runs of consecutive numbers, so an opening costs about one run per
+//   row it spans.
+struct BoardDelta
+{
+    struct Run
+    {
+        int64_t first;
+        int64_t length;
+    };
+
+    uint64_t sequence {0};
+    // Set on the first delta of every game, which has no runs since every
+    //   tile starts out covered
+    bool newGame {false};
+
+    int32_t boardWidth {0};
+    int32_t boardHeight {0};
+    int32_t mineCount {0};
+    Topology topology {Topology::SQUARE};
+    GameState gameState {GameState::GAME_NOT_STARTED};
+    int64_t lastClicked {-1};
+
+    std::vector<Run> runs;
+    // New value of every tile in the runs, in order, packed as on the board
+    //   but without the telegraph bit. Covered and flagged tiles only carry
+    //   their state, so the stream gives away no mines, until the game is lost.
+    std::vector<uint8_t> tiles;
+};
+
+// Which sprite a packed tile is drawn with. Detonated is true for the tile
+//   that was clicked last, which shows the exploded mine if it had one.
+SpriteType getTileSprite(uint8_t tile, GameState gameState, bool detonated);
+
+class GameBoard
 {
 private:
     int32_t boardWidth;
     int32_t boardHeight;
     int32_t mineCount;
-    int32_t numTiles;
-
-    TextureManager textureMgr;
+    int64_t numTiles;
+    int32_t stride;
+    Topology topology {Topology::SQUARE};
 
     GameState gameState;
     bool clockStarted;
     sf::Clock gameClock;
     sf::Time finishTime;
 
-    std::set<std::tuple<int32_t, int32_t>> mineLocation;
-    std::vector<int32_t> mineCounts;
-    std::vector<TileState> boardState;
-    std::tuple<int32_t, int32_t> lastClickedCoords;
+    // The board is surrounded by a one-tile border of uncovered, mine-free
+    //   tiles, so neighbour lookups never need a bounds check
+    TileStorage tiles;
+    int64_t lastClickedIndex {-1};
+
+    // Kept up to date as tiles change so that nothing has to scan the board
+    int64_t numCoveredSafe;
+    int32_t numFlags;
+    bool mineDetonated;
+
+    // Frontier of the reveal in progress, kept between calls so a huge
+    //   opening can be spread over many steps. Entries before fillHead are
+    //   done. It keeps its capacity between fills.
+    std::vector<int64_t> fillQueue;
+    size_t fillHead {0};
+
+    std::array<int64_t, 9> telegraphedTiles;
+    int32_t numTelegraphed {0};
+
+    // Tiles whose state changed since the last delta, kept only while
+    //   something is listening. It keeps its capacity between deltas.
+    bool recordingChanges {false};
+    std::vector<int64_t> changedTiles;
+    std::vector<uint64_t> changedBitmap;
+
+    // Union-find forest over the empty tiles, used to label openings for 3BV.
+    //   Tiles that are not part of an opening hold -1. Paged boards are too
+    //   big for this and leave the 3BV at 0.
+    std::vector<int32_t> openingParent;
+    GameStats stats;
+
+    inline int64_t flatten(int32_t x, int32_t y) const
+    {
+        return (x + 1) + (y + 1) * static_cast<int64_t>(this->stride);
+    }
 
-    std::set<std::tuple<int32_t, int32_t>> telegraphedTile;
+    // Index of a tile numbered row by row from 0. Stays in 64 bits throughout,
+    //   since boards can hold more tiles than an int32_t can count.
+    inline int64_t flattenTile(int64_t tile) const
+    {
+        return (tile % this->boardWidth + 1) + (tile / this->boardWidth + 1) * int64_t {this->stride};
+    }
 
-    inline auto flatten(int32_t x, int32_t y) const
+    inline auto getGeometry() const
     {
-        return x + y * this->boardWidth;
+        return BoardGeometry {this->boardWidth, this->boardHeight, this->stride};
     }
 
-    inline auto deflatten(int32_t index) const
+    inline auto isMine(int64_t index) const
     {
-        return std::make_tuple(index % this->boardWidth, index / this->boardWidth);
+        return (this->tiles[index] & TILE_MINE_BIT) != 0;
     }
 
-    inline auto getMineCount(int32_t x, int32_t y) const
+    inline auto getMineCount(int64_t index) const
     {
-        return this->mineCounts[flatten(x, y)];
+        return this->tiles[index] & TILE_COUNT_MASK;
     }
 
-    inline auto setMineCount(int32_t x, int32_t y, int32_t value)
+    inline auto getBoardState(int64_t index) const
     {
-        this->mineCounts[flatten(x, y)] = value;
+        return static_cast<TileState>((this->tiles[index] & TILE_STATE_MASK) >> TILE_STATE_SHIFT);
     }
 
-    inline auto getBoardState(int32_t x, int32_t y) const
+    // Every change a player can see goes through here, so it is also where
+    //   changes are recorded
+    inline auto setBoardState(int64_t index, TileState value)
     {
-        return this->boardState[flatten(x, y)];
+        this->tiles[index] = (this->tiles[index] & ~TILE_STATE_MASK) | packTileState(value);
+        if (this->recordingChanges)
+            this->changedTiles.push_back(index);
     }
 
-    inline auto setBoardState(int32_t x, int32_t y, TileState value)
+    inline auto uncoverTile(int64_t index)
     {
-        this->boardState[flatten(x, y)] = value;
+        this->setBoardState(index, TileState::UNCOVERED);
+        if (this->isMine(index))
+            this->mineDetonated = true;
+        else
+            this->numCoveredSafe--;
     }
 
     inline auto isOutOfBounds(float x, float y) const
@@ -151,22 +341,51 @@ private:
         return x < 0 or x >= this->boardWidth or y < 0 or y >= this->boardHeight;
     }
 
-    int32_t getMineNumber(std::tuple<int32_t, int32_t> coords) const;
-    int32_t countFlags(int32_t x, int32_t y) const;
+    // Runs fn with the policy for the current topology, so everything inside
+    //   it is compiled once per topology with no dispatch in the tile loops
+    template<typename Fn>
+    decltype(auto) withTopology(Fn&& fn) const
+    {
+        switch (this->topology)
+        {
+        case Topology::TORUS:
+            return fn(TorusTopology {});
+        case Topology::HEXAGONAL:
+            return fn(HexTopology {});
+        case Topology::SQUARE:
+        default:
+            return fn(SquareTopology {});
+        }
+    }
+
+    template<typename Topo>
+    void placeMine(int64_t index);
+    template<typename Topo>
+    void removeMine(int64_t index);
+    template<typename Topo>
+    int32_t countFlags(int64_t index) const;
 
     bool checkWinCon() const;
     bool checkLoseCon() const;
+    void checkGameOver();
 
-    void floodFill(int32_t x, int32_t y);
+    int32_t findOpening(int32_t index);
+    template<typename Topo>
+    void computeBoardValue();
 
-    virtual void draw(sf::RenderTarget& target, sf::RenderStates states) const;
+    void queueReveal(int64_t index);
+    template<typename Topo>
+    void floodFill(int64_t maxTiles);
+    template<typename Topo>
+    void interactTile(int64_t index, sf::Mouse::Button mouseBtn);
+    template<typename Topo>
+    void telegraphTile(int64_t index);
+    void prefetchAround(int32_t firstX, int32_t firstY, int32_t lastX, int32_t lastY) const;
 
 public:
-    GameBoard(int32_t boardWidth, int32_t boardHeight, int32_t mineCount): textureMgr()
+    GameBoard(int32_t boardWidth, int32_t boardHeight, int32_t mineCount, Topology topology = Topology::SQUARE)
     {
-        this->textureMgr.loadTextures();
-
-        this->initialize(boardWidth, boardHeight, mineCount);
+        this->initialize(boardWidth, boardHeight, mineCount, topology);
     }
 
     void initialize()
@@ -174,37 +393,115 @@ public:
         this->initialize(this->boardWidth, this->boardHeight, this->mineCount);
     }
 
-    inline std::tuple<uint32_t, uint32_t> getDrawableSize() const
+    void initialize(Topology topology)
     {
-        return std::make_tuple(this->boardWidth * TILE_SIZE + 2 * MARGIN,
-                               this->boardHeight * TILE_SIZE + 3 * MARGIN + DIGIT_HEIGHT);
+        this->initialize(this->boardWidth, this->boardHeight, this->mineCount, topology);
     }
 
-    constexpr std::tuple<uint32_t, uint32_t> getBoardOffset() const
+    inline auto getGameState() const
     {
-        return std::make_tuple(MARGIN, 2 * MARGIN + DIGIT_HEIGHT);
+        return this->gameState;
     }
 
-    inline auto getGameState() const
+    inline auto getTopology() const
     {
-        return this->gameState;
+        return this->topology;
+    }
+
+    inline auto getBoardConfig() const
+    {
+        return std::make_tuple(this->boardWidth, this->boardHeight, this->mineCount);
+    }
+
+    inline auto const& getStats() const
+    {
+        return this->stats;
+    }
+
+    inline auto getFinishTime() const
+    {
+        return this->finishTime;
+    }
+
+    void initialize(int32_t boardWidth, int32_t boardHeight, int32_t mineCount)
+    {
+        this->initialize(boardWidth, boardHeight, mineCount, this->topology);
     }
 
-    void initialize(int32_t boardWidth, int32_t boardHeight, int32_t mineCount);
+    void initialize(int32_t boardWidth, int32_t boardHeight, int32_t mineCount, Topology topology);
 
     void interact(float x, float y, sf::Mouse::Button mouseBtn);
     void telegraph(float x, float y);
     void clearTelegraph();
 
-    bool hasMine(float x, float y)
+    // A click only starts the reveal of any opening it lands on. The rest is
+    //   opened by advanceReveal, and the game cannot be won until it is done.
+    inline bool isRevealing() const
+    {
+        return this->fillHead < this->fillQueue.size();
+    }
+
+    // Opens the surroundings of up to maxTiles more empty tiles. Returns true
+    //   if the reveal still has more to do.
+    bool advanceReveal(int64_t maxTiles);
+
+    // Overwrites every field of snapshot except the version. The region
+    //   starts at the given tile, moved back if it would run off the board.
+    void publish(BoardSnapshot& snapshot, int32_t originX = 0, int32_t originY = 0) const;
+
+    // Changes are only recorded while this is on. Starting a game discards
+    //   any that were not taken.
+    void setRecordingChanges(bool recording);
+
+    // Overwrites every field of delta except the sequence and newGame with
+    //   the tiles changed since the last call. Returns false if none did.
+    bool takeDelta(BoardDelta& delta);
+
+    // Fills position with what the player can see of an ongoing game. Returns
+    //   false if too many tiles are still covered to solve.
+    bool getEndgamePosition(EndgamePosition& position) const;
+};
+
+// Draws whatever snapshot it was last given. The snapshot must stay alive
+//   until the next call to setSnapshot.
+class BoardView : public sf::Drawable
+{
+private:
+    TextureManager const& textureMgr {TextureManager::getInstance()};
+    BoardSnapshot const* snapshot {nullptr};
+
+    virtual void draw(sf::RenderTarget& target, sf::RenderStates states) const;
+
+public:
+    void setSnapshot(BoardSnapshot const& snapshot)
+    {
+        this->snapshot = &snapshot;
+    }
+
+    inline std::tuple<uint32_t, uint32_t> getDrawableSize() const
+    {
+        auto hexShift = this->snapshot->topology == Topology::HEXAGONAL ? TILE_SIZE / 2 : 0;
+        return std::make_tuple(this->snapshot->regionWidth * TILE_SIZE + hexShift + 2 * MARGIN,
+                               this->snapshot->regionHeight * TILE_SIZE + 3 * MARGIN + DIGIT_HEIGHT);
+    }
+
+    constexpr std::tuple<uint32_t, uint32_t> getBoardOffset() const
+    {
+        return std::make_tuple(MARGIN, 2 * MARGIN + DIGIT_HEIGHT);
+    }
+
+    bool hasMine(float x, float y) const
     {
 #ifndef DEBUG
         return false;
 
 #endif
-        if (this->isOutOfBounds(x, y))
+        x -= getRowShift(this->snapshot->topology, y) + this->snapshot->regionX;
+        y -= this->snapshot->regionY;
+        if (x < 0 or x >= this->snapshot->regionWidth or y < 0 or y >= this->snapshot->regionHeight)
             return false;
 
-        return this->mineLocation.contains({x, y});
+        auto index = static_cast<int32_t>(x) + static_cast<int64_t>(y) * this->snapshot->regionWidth;
+        return (this->snapshot->tiles[index] & TILE_MINE_BIT) != 0;
     }
 };
@@ -0,0 +1,170 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+// Multiset of keys that answers rank and order queries in logarithmic time.
+//   Stored as a treap with subtree sizes, with the nodes packed into one
+//   vector and linked by index. Keys ordered first by Compare rank best.
+template<typename Key, typename Compare = std::less<Key>>
+class RankIndex
+{
+private:
+    struct Node
+    {
+        Key key;
+        uint32_t priority;
+        int32_t left {-1};
+        int32_t right {-1};
+        int32_t size {1};
+    };
+
+    std::vector<Node> nodes;
+    int32_t root {-1};
+    uint32_t seed {0x9E3779B9};
+    Compare compare {};
+
+    // Scratch space for insert, reused between calls
+    std::vector<int32_t> path;
+
+    inline int32_t getSize(int32_t node) const
+    {
+        return node < 0 ? 0 : this->nodes[node].size;
+    }
+
+    // Xorshift is plenty for heap priorities
+    inline uint32_t nextPriority()
+    {
+        this->seed ^= this->seed << 13;
+        this->seed ^= this->seed >> 17;
+        this->seed ^= this->seed << 5;
+        return this->seed;
+    }
+
+public:
+    void insert(Key key)
+    {
+        auto priority = this->nextPriority();
+        auto inserted = static_cast<int32_t>(this->nodes.size());
+        this->nodes.push_back({key, priority});
+
+        // Walk down until the new node outranks the subtree's root. Every
+        //   node passed on the way gains one descendant.
+        auto* slot = &this->root;
+        while (*slot >= 0 and this->nodes[*slot].priority > priority)
+        {
+            auto& node = this->nodes[*slot];
+            node.size++;
+            slot = this->compare(node.key, key) ? &node.right : &node.left;
+        }
+
+        // Split that subtree around the key to form the new node's children
+        auto node       = *slot;
+        *slot           = inserted;
+        auto* leftSlot  = &this->nodes[inserted].left;
+        auto* rightSlot = &this->nodes[inserted].right;
+        this->path.clear();
+        while (node >= 0)
+        {
+            this->path.push_back(node);
+            if (this->compare(this->nodes[node].key, key))
+            {
+                *leftSlot = node;
+                leftSlot  = &this->nodes[node].right;
+                node      = this->nodes[node].right;
+            }
+            else
+            {
+                *rightSlot = node;
+                rightSlot  = &this->nodes[node].left;
+                node       = this->nodes[node].left;
+            }
+        }
+        *leftSlot  = -1;
+        *rightSlot = -1;
+
+        // Nodes further down the split were visited later, so fixing sizes in
+        //   reverse order always sees correct children
+        for (auto it = this->path.rbegin(); it != this->path.rend(); it++)
+        {
+            auto& split = this->nodes[*it];
+            split.size  = 1 + this->getSize(split.left) + this->getSize(split.right);
+        }
+        auto& created = this->nodes[inserted];
+        created.size  = 1 + this->getSize(created.left) + this->getSize(created.right);
+    }
+
+    inline int64_t size() const
+    {
+        return this->getSize(this->root);
+    }
+
+    // Number of keys that rank strictly better than key
+    int64_t countBefore(Key const& key) const
+    {
+        int64_t count = 0;
+        for (auto node = this->root; node >= 0;)
+        {
+            if (this->compare(this->nodes[node].key, key))
+            {
+                count += this->getSize(this->nodes[node].left) + 1;
+                node = this->nodes[node].right;
+            }
+            else
+                node = this->nodes[node].left;
+        }
+
+        return count;
+    }
+
+    // Number of keys that rank strictly worse than key
+    int64_t countAfter(Key const& key) const
+    {
+        int64_t count = 0;
+        for (auto node = this->root; node >= 0;)
+        {
+            if (this->compare(key, this->nodes[node].key))
+            {
+                count += this->getSize(this->nodes[node].right) + 1;
+                node = this->nodes[node].left;
+            }
+            else
+                node = this->nodes[node].right;
+        }
+
+        return count;
+    }
+
+    // 1-based, ties share the best rank
+    inline int64_t getRank(Key const& key) const
+    {
+        return this->countBefore(key) + 1;
+    }
+
+    // Share of recorded keys that key beats outright, from 0 to 100
+    inline float getPercentile(Key const& key) const
+    {
+        return this->size() == 0 ? 0.0f : 100.0f * this->countAfter(key) / this->size();
+    }
+
+    // The key at 0-based position index in rank order
+    Key const& select(int64_t index) const
+    {
+        auto node = this->root;
+        while (true)
+        {
+            auto leftSize = this->getSize(this->nodes[node].left);
+            if (index == leftSize)
+                return this->nodes[node].key;
+
+            if (index < leftSize)
+                node = this->nodes[node].left;
+            else
+            {
+                index -= leftSize + 1;
+                node = this->nodes[node].right;
+            }
+        }
+    }
+};
@@ -0,0 +1,277 @@
+#include "Simulation.h"
+
+#include "AllocationCounter.h"
+#include "Trace.h"
+
+GameSimulation::GameSimulation(int32_t boardWidth, int32_t boardHeight, int32_t mineCount,
+                               std::vector<std::unique_ptr<DeltaSink>> deltaSinks):
+    deltaSinks(std::move(deltaSinks))
+{
+    if (!this->startPreset(boardWidth, boardHeight, mineCount, Topology::SQUARE))
+    {
+        this->gameBoard = std::make_unique<GameBoard>(boardWidth, boardHeight, mineCount);
+        this->boardFactory.request(boardWidth, boardHeight, mineCount, this->gameBoard->getTopology());
+    }
+    auto recording = !this->deltaSinks.empty();
+    this->withBoard([recording](auto& board) { board.setRecordingChanges(recording); });
+    this->publishDelta(true);
+
+    // The render thread has a snapshot to draw before the first command
+    this->publish();
+    this->snapshots.update();
+
+    this->thread = std::thread {&GameSimulation::run, this};
+}
+
+GameSimulation::~GameSimulation()
+{
+    this->running.store(false, std::memory_order_release);
+    this->wake();
+    this->thread.join();
+}
+
+void GameSimulation::post(BoardCommand const& command)
+{
+    // Input is never dropped
+    while (!this->commands.push(command))
+    {
+        this->wake();
+        std::this_thread::yield();
+    }
+
+    this->wake();
+}
+
+void GameSimulation::wake()
+{
+    this->signal.fetch_add(1, std::memory_order_release);
+    this->signal.notify_one();
+}
+
+void GameSimulation::run()
+{
+    consoleLog("Starting simulation thread...");
+    Tracer::setThreadName("Simulation");
+    while (this->running.load(std::memory_order_acquire))
+    {
+        // Read before draining, so a post that lands in between makes the
+        //   wait below return straight away
+        auto signal = this->signal.load(std::memory_order_acquire);
+        this->sendResults();
+
+        // Everything queued up since the last pass is handled in one go and
+        //   published once
+        BoardCommand command;
+        bool changed = false;
+        while (this->commands.pop(command))
+        {
+            TRACE_SCOPE("GameSimulation::execute");
+            this->execute(command);
+            this->publishDelta(false);
+            changed = true;
+        }
+
+        // Input always goes first, so a click made mid-reveal acts on the board
+        //   as it was last shown
+        auto isRevealing = [this] { return this->withBoard([](auto& board) { return board.isRevealing(); }); };
+        if (isRevealing())
+        {
+            this->advanceReveal();
+            this->publishDelta(false);
+            changed = true;
+        }
+        if (changed)
+            this->publish();
+        if (isRevealing())
+            continue;
+
+        if (this->analysisPending)
+        {
+            this->analysisPending = false;
+            this->analyse();
+            this->publish();
+        }
+
+        this->signal.wait(signal, std::memory_order_acquire);
+    }
+}
+
+void GameSimulation::execute(BoardCommand const& command)
+{
+    this->withBoard([this, &command](auto& board) { this->execute(board, command); });
+}
+
+template<typename Board>
+void GameSimulation::execute(Board& board, BoardCommand const& command)
+{
+    switch (command.type)
+    {
+    case CommandType::TELEGRAPH:
+    {
+        AllocationScope allocScope;
+        board.telegraph(command.x, command.y);
+        this->hotPathAllocations += allocScope.getCount();
+        break;
+    }
+    case CommandType::RELEASE:
+        board.clearTelegraph();
+        switch (board.getGameState())
+        {
+        case GameState::GAME_NOT_STARTED:
+        case GameState::GAME_ONGOING:
+        {
+            AllocationScope allocScope;
+            board.interact(command.x, command.y, command.mouseBtn);
+            this->hotPathAllocations += allocScope.getCount();
+
+            if (board.getGameState() == GameState::GAME_WON)
+                this->pushResult();
+            this->analysisPending = true;
+            break;
+        }
+        case GameState::GAME_WON:
+        case GameState::GAME_LOST:
+        {
+            auto [boardWidth, boardHeight, mineCount] = board.getBoardConfig();
+            this->startGame(boardWidth, boardHeight, mineCount, board.getTopology());
+            break;
+        }
+        }
+        break;
+    case CommandType::NEW_GAME:
+        this->startGame(command.boardWidth, command.boardHeight, command.mineCount, command.topology);
+        break;
+    case CommandType::VIEWPORT:
+        this->viewportX = static_cast<int32_t>(command.x);
+        this->viewportY = static_cast<int32_t>(command.y);
+        break;
+    }
+}
+
+void GameSimulation::startGame(int32_t boardWidth, int32_t boardHeight, int32_t mineCount, Topology topology)
+{
+    // Whatever the last move changed goes out before the board is replaced
+    this->publishDelta(false);
+    if (this->startPreset(boardWidth, boardHeight, mineCount, topology))
+    {
+        // Nothing is built ahead for a preset, and a big board left over from
+        //   before is only holding on to memory
+        this->boardFactory.clear();
+        this->gameBoard.reset();
+    }
+    else
+    {
+        this->presetBoard = std::monostate {};
+        if (auto board = this->boardFactory.take(boardWidth, boardHeight, mineCount, topology))
+            this->gameBoard = std::move(board);
+        else if (this->gameBoard)
+            this->gameBoard->initialize(boardWidth, boardHeight, mineCount, topology);
+        else
+            this->gameBoard = std::make_unique<GameBoard>(boardWidth, boardHeight, mineCount, topology);
+
+        // Also drops any board built for the previous config
+        this->boardFactory.request(boardWidth, boardHeight, mineCount, topology);
+    }
+
+    auto recording = !this->deltaSinks.empty();
+    this->withBoard([recording](auto& board) { board.setRecordingChanges(recording); });
+    this->publishDelta(true);
+    this->endgame = {};
+}
+
+bool GameSimulation::startPreset(int32_t boardWidth, int32_t boardHeight, int32_t mineCount, Topology topology)
+{
+    auto start = [&]<typename Board>(std::type_identity<Board>)
+    {
+        if (topology != Topology::SQUARE or boardWidth != Board::BOARD_WIDTH or
+            boardHeight != Board::BOARD_HEIGHT or mineCount != Board::MINE_COUNT)
+            return false;
+
+        if (auto* board = std::get_if<Board>(&this->presetBoard))
+            board->initialize();
+        else
+            this->presetBoard.template emplace<Board>();
+        return true;
+    };
+
+    return start(std::type_identity<BeginnerBoard> {}) or start(std::type_identity<IntermediateBoard> {}) or
+           start(std::type_identity<ExpertBoard> {});
+}
+
+void GameSimulation::advanceReveal()
+{
+    TRACE_SCOPE("GameSimulation::advanceReveal");
+    auto sliceEnd = std::chrono::steady_clock::now() + REVEAL_SLICE;
+
+    // Only a GameBoard ever has a reveal to step
+    AllocationScope allocScope;
+    while (this->gameBoard->advanceReveal(REVEAL_STEP))
+        if (!this->commands.isEmpty() or std::chrono::steady_clock::now() >= sliceEnd)
+            break;
+    this->hotPathAllocations += allocScope.getCount();
+
+    // The last tile of an opening can be the one that wins
+    if (this->gameBoard->getGameState() == GameState::GAME_WON)
+        this->pushResult();
+}
+
+void GameSimulation::pushResult()
+{
+    this->withBoard(
+        [this](auto& board)
+        {
+            auto [boardWidth, boardHeight, mineCount] = board.getBoardConfig();
+            this->unsentResults.push_back({boardWidth, boardHeight, mineCount, board.getTopology(),
+                                           board.getFinishTime(), board.getStats()});
+        });
+    this->sendResults();
+}
+
+void GameSimulation::sendResults()
+{
+    while (!this->unsentResults.empty() and this->results.push(this->unsentResults.front()))
+        this->unsentResults.pop_front();
+}
+
+void GameSimulation::analyse()
+{
+    // A finished game keeps the analysis of the position before its last move
+    if (this->withBoard([](auto& board) { return board.getGameState(); }) != GameState::GAME_ONGOING)
+        return;
+
+    if (!this->withBoard([this](auto& board) { return board.getEndgamePosition(this->endgamePosition); }))
+    {
+        this->endgame = {};
+        return;
+    }
+
+    TRACE_SCOPE("GameSimulation::analyse");
+    // New input cuts the solve short, keeping the deepest search finished
+    this->endgame = this->solver.solve(this->endgamePosition, ENDGAME_BUDGET,
+                                       [this] { return !this->commands.isEmpty(); });
+}
+
+void GameSimulation::publish()
+{
+    auto& snapshot = this->snapshots.getBack();
+    this->withBoard([&](auto& board) { board.publish(snapshot, this->viewportX, this->viewportY); });
+    snapshot.version            = ++this->version;
+    snapshot.hotPathAllocations = this->hotPathAllocations;
+    snapshot.endgame            = this->endgame;
+    this->snapshots.publish();
+}
+
+void GameSimulation::publishDelta(bool newGame)
+{
+    if (this->deltaSinks.empty())
+        return;
+
+    if (!this->withBoard([this](auto& board) { return board.takeDelta(this->delta); }) and !newGame)
+        return;
+
+    TRACE_SCOPE("GameSimulation::publishDelta");
+    this->delta.sequence = ++this->deltaSequence;
+    this->delta.newGame  = newGame;
+    for (auto& sink: this->deltaSinks)
+        sink->publish(this->delta);
+}
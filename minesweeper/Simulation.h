@@ -0,0 +1,171 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <thread>
+#include <type_traits>
+#include <variant>
+#include <vector>
+
+#include <SFML/Graphics.hpp>
+
+#include "BitBoard.h"
+#include "BoardFactory.h"
+#include "DeltaSink.h"
+#include "EndgameSolver.h"
+#include "Minesweeper.h"
+#include "SpscQueue.h"
+#include "TripleBuffer.h"
+
+enum class CommandType : uint8_t
+{
+    TELEGRAPH,
+    RELEASE,
+    NEW_GAME,
+    // Moves the region snapshots carry to start at tile x, y
+    VIEWPORT,
+};
+
+// Input sent from the render thread. Fields a command does not use are ignored.
+struct BoardCommand
+{
+    CommandType type {CommandType::TELEGRAPH};
+    float x {0};
+    float y {0};
+    sf::Mouse::Button mouseBtn {sf::Mouse::Button::Left};
+    int32_t boardWidth {0};
+    int32_t boardHeight {0};
+    int32_t mineCount {0};
+    Topology topology {Topology::SQUARE};
+};
+
+// A won game, handed back to the render thread so none are missed even if
+//   several snapshots go by unseen
+struct GameResult
+{
+    int32_t boardWidth;
+    int32_t boardHeight;
+    int32_t mineCount;
+    Topology topology;
+    sf::Time finishTime;
+    GameStats stats;
+};
+
+// Runs the game board on its own thread. The render thread posts input and
+//   picks up snapshots of the board, and neither thread ever waits on the
+//   other, so a long flood fill cannot hold up drawing.
+class GameSimulation
+{
+private:
+    static constexpr size_t COMMAND_CAPACITY {256};
+    static constexpr size_t RESULT_CAPACITY {16};
+    static constexpr std::chrono::milliseconds ENDGAME_BUDGET {250};
+    // A reveal opens this many tiles between checks for new input, and is
+    //   published at least once per slice so big openings spread visibly
+    static constexpr int64_t REVEAL_STEP {4096};
+    static constexpr std::chrono::milliseconds REVEAL_SLICE {16};
+
+    // The classic presets are played on a BitBoard, which handles a move in a
+    //   few row operations. Anything else is played on the GameBoard, which is
+    //   only made once a game needs it.
+    std::variant<std::monostate, BeginnerBoard, IntermediateBoard, ExpertBoard> presetBoard;
+    // Held by pointer so a board built ahead by the factory can be swapped in
+    std::unique_ptr<GameBoard> gameBoard;
+    BoardFactory boardFactory;
+    uint64_t version {0};
+    // Allocations made inside GameBoard::interact and telegraph. These are
+    //   expected to stay at zero once a game is underway.
+    uint64_t hotPathAllocations {0};
+    int32_t viewportX {0};
+    int32_t viewportY {0};
+
+    // Solved after the move that made the position has been published, so a
+    //   slow solve never delays the board itself
+    EndgameSolver solver;
+    EndgamePosition endgamePosition;
+    EndgameResult endgame;
+    bool analysisPending {false};
+
+    // Deltas go out after every command and every reveal slice, each covering
+    //   the tiles changed since the one before
+    std::vector<std::unique_ptr<DeltaSink>> deltaSinks;
+    BoardDelta delta;
+    uint64_t deltaSequence {0};
+
+    SpscQueue<BoardCommand, COMMAND_CAPACITY> commands;
+    SpscQueue<GameResult, RESULT_CAPACITY> results;
+    // Won games the results queue had no room for, sent in order as the
+    //   render thread makes room
+    std::deque<GameResult> unsentResults;
+    TripleBuffer<BoardSnapshot> snapshots;
+
+    // Bumped on every post, so the simulation thread can sleep while idle
+    std::atomic<uint32_t> signal {0};
+    std::atomic<bool> running {true};
+    std::thread thread;
+
+    // Calls fn with whichever board is being played
+    template<typename Fn>
+    decltype(auto) withBoard(Fn&& fn)
+    {
+        return std::visit(
+            [&]<typename Board>(Board& board) -> decltype(auto)
+            {
+                if constexpr (std::is_same_v<Board, std::monostate>)
+                    return fn(*this->gameBoard);
+                else
+                    return fn(board);
+            },
+            this->presetBoard);
+    }
+
+    void run();
+    void execute(BoardCommand const& command);
+    template<typename Board>
+    void execute(Board& board, BoardCommand const& command);
+    void startGame(int32_t boardWidth, int32_t boardHeight, int32_t mineCount, Topology topology);
+    bool startPreset(int32_t boardWidth, int32_t boardHeight, int32_t mineCount, Topology topology);
+    void advanceReveal();
+    void pushResult();
+    void sendResults();
+    void analyse();
+    void publish();
+    void publishDelta(bool newGame);
+    void wake();
+
+public:
+    GameSimulation(int32_t boardWidth, int32_t boardHeight, int32_t mineCount,
+                   std::vector<std::unique_ptr<DeltaSink>> deltaSinks = {});
+    GameSimulation(GameSimulation const&) = delete;
+    void operator=(GameSimulation const&) = delete;
+    ~GameSimulation();
+
+    // Render thread only. Only waits if the simulation is a whole queue behind.
+    void post(BoardCommand const& command);
+
+    // Render thread only. Returns true if a newer snapshot was picked up.
+    inline bool update()
+    {
+        return this->snapshots.update();
+    }
+
+    // Render thread only. Stays valid until the next call to update.
+    inline auto const& getSnapshot() const
+    {
+        return this->snapshots.getFront();
+    }
+
+    // Render thread only
+    inline bool popResult(GameResult& result)
+    {
+        if (!this->results.pop(result))
+            return false;
+
+        // The simulation may be holding results back until there is room
+        this->wake();
+        return true;
+    }
+};
@@ -0,0 +1,145 @@
+#include "Spectator.h"
+
+#include "Bot.h"
+#include "Trace.h"
+
+#include <algorithm>
+#include <cmath>
+#include <ranges>
+
+SpectatorGrid::SpectatorGrid(int32_t numBoards): seats(numBoards)
+{
+    consoleLog("Initializing spectator grid...");
+    this->columns = static_cast<int32_t>(std::ceil(std::sqrt(static_cast<float>(numBoards))));
+
+    // Positions never change, so only texture coordinates are written after
+    //   this
+    this->vertices.resize(static_cast<size_t>(numBoards) * BOARD_VERTICES);
+    for (auto seat: std::views::iota(0, numBoards))
+    {
+        auto originX = (seat % this->columns) * (Board::BOARD_WIDTH + BOARD_GAP) * static_cast<float>(TILE_SIZE);
+        auto originY = (seat / this->columns) * (Board::BOARD_HEIGHT + BOARD_GAP) * static_cast<float>(TILE_SIZE);
+        for (auto tile: std::views::iota(0, BOARD_TILES))
+        {
+            auto left   = originX + (tile % Board::BOARD_WIDTH) * static_cast<float>(TILE_SIZE);
+            auto top    = originY + (tile / Board::BOARD_WIDTH) * static_cast<float>(TILE_SIZE);
+            auto* quad  = &this->vertices[static_cast<size_t>(seat) * BOARD_VERTICES + 4 * tile];
+
+            quad[0].position = {left, top};
+            quad[1].position = {left + TILE_SIZE, top};
+            quad[2].position = {left + TILE_SIZE, top + TILE_SIZE};
+            quad[3].position = {left, top + TILE_SIZE};
+            this->setTexCoords(static_cast<int64_t>(seat) * BOARD_VERTICES + 4 * tile, SpriteType::COVERED_TILE);
+        }
+
+        this->seats[seat].drawn.fill(SpriteType::COVERED_TILE);
+        this->seats[seat].rng.seed(seat + 1);
+    }
+
+    if (sf::VertexBuffer::isAvailable())
+    {
+        this->vertexBuffer.create(this->vertices.size());
+        this->vertexBuffer.update(this->vertices.data());
+    }
+}
+
+void SpectatorGrid::setTexCoords(int64_t vertex, SpriteType spriteType)
+{
+    auto rect  = TextureManager::getTextureRect(spriteType);
+    auto left  = static_cast<float>(rect.left);
+    auto top   = static_cast<float>(rect.top);
+    auto right = static_cast<float>(rect.left + rect.width);
+    auto bot   = static_cast<float>(rect.top + rect.height);
+
+    auto* quad        = &this->vertices[vertex];
+    quad[0].texCoords = {left, top};
+    quad[1].texCoords = {right, top};
+    quad[2].texCoords = {right, bot};
+    quad[3].texCoords = {left, bot};
+}
+
+bool SpectatorGrid::playMove(Seat& seat)
+{
+    auto& board = seat.board;
+    switch (board.getGameState())
+    {
+    case GameState::GAME_WON:
+    case GameState::GAME_LOST:
+        if (--seat.restartIn > 0)
+            return false;
+        board.initialize();
+        return true;
+    case GameState::GAME_NOT_STARTED:
+    case GameState::GAME_ONGOING:
+        break;
+    }
+
+    return playBotMove(board, seat.rng);
+}
+
+void SpectatorGrid::refresh(int32_t seatIndex)
+{
+    auto& seat = this->seats[seatIndex];
+    seat.board.publish(seat.snapshot);
+
+    auto const& snapshot = seat.snapshot;
+    auto base            = static_cast<int64_t>(seatIndex) * BOARD_VERTICES;
+    int32_t firstChanged = BOARD_TILES;
+    int32_t lastChanged  = -1;
+    for (auto tile: std::views::iota(0, BOARD_TILES))
+    {
+        auto detonated = snapshot.lastClickedX + snapshot.lastClickedY * Board::BOARD_WIDTH == tile;
+        auto sprite    = getTileSprite(snapshot.tiles[tile], snapshot.gameState, detonated);
+        if (sprite == seat.drawn[tile])
+            continue;
+
+        seat.drawn[tile] = sprite;
+        this->setTexCoords(base + 4 * tile, sprite);
+        firstChanged = std::min(firstChanged, tile);
+        lastChanged  = tile;
+    }
+
+    // One upload per board covering just the span of tiles that changed
+    if (lastChanged >= 0 and sf::VertexBuffer::isAvailable())
+        this->vertexBuffer.update(&this->vertices[base + 4 * firstChanged], 4 * (lastChanged - firstChanged + 1),
+                                  static_cast<uint32_t>(base + 4 * firstChanged));
+}
+
+void SpectatorGrid::update()
+{
+    TRACE_SCOPE("SpectatorGrid::update");
+    for (auto i: std::views::iota(0, this->getNumBoards()))
+    {
+        auto& seat      = this->seats[i];
+        auto wasOngoing = seat.board.getGameState() == GameState::GAME_ONGOING;
+        if (!this->playMove(seat))
+            continue;
+
+        auto state = seat.board.getGameState();
+        if (wasOngoing and (state == GameState::GAME_WON or state == GameState::GAME_LOST))
+        {
+            (state == GameState::GAME_WON ? this->numWins : this->numLosses)++;
+            seat.restartIn = RESTART_DELAY;
+        }
+
+        this->refresh(i);
+    }
+}
+
+std::tuple<uint32_t, uint32_t> SpectatorGrid::getDrawableSize() const
+{
+    auto rows = (this->getNumBoards() + this->columns - 1) / this->columns;
+    return std::make_tuple(
+        (this->columns * (Board::BOARD_WIDTH + BOARD_GAP) - BOARD_GAP) * TILE_SIZE,
+        (rows * (Board::BOARD_HEIGHT + BOARD_GAP) - BOARD_GAP) * TILE_SIZE);
+}
+
+void SpectatorGrid::draw(sf::RenderTarget& target, sf::RenderStates states) const
+{
+    TRACE_SCOPE("SpectatorGrid::draw");
+    states.texture = &TextureManager::getInstance().getTileset();
+    if (sf::VertexBuffer::isAvailable())
+        target.draw(this->vertexBuffer, states);
+    else
+        target.draw(this->vertices.data(), this->vertices.size(), sf::Quads, states);
+}
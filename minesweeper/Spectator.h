@@ -0,0 +1,77 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <random>
+#include <tuple>
+#include <vector>
+
+#include <SFML/Graphics.hpp>
+
+#include "BitBoard.h"
+#include "Minesweeper.h"
+
+// Plays many bot games side by side and draws all of them in one call. Every
+//   board owns a fixed range of one shared vertex buffer, textured from the
+//   shared tileset, and only tiles that changed since the last frame are
+//   rewritten and uploaded.
+class SpectatorGrid : public sf::Drawable
+{
+private:
+    using Board = ExpertBoard;
+
+    static constexpr int32_t BOARD_TILES {Board::BOARD_WIDTH * Board::BOARD_HEIGHT};
+    static constexpr int32_t BOARD_VERTICES {4 * BOARD_TILES};
+    // Space left between neighbouring boards, in tiles
+    static constexpr int32_t BOARD_GAP {2};
+    // Frames a finished game stays up before its bot starts the next one
+    static constexpr int32_t RESTART_DELAY {90};
+
+    struct Seat
+    {
+        Board board;
+        BoardSnapshot snapshot;
+        // Sprites as they are in the vertex buffer, to find what changed
+        std::array<SpriteType, BOARD_TILES> drawn;
+        std::minstd_rand rng;
+        int32_t restartIn {0};
+    };
+
+    std::vector<Seat> seats;
+    int32_t columns;
+    int32_t numWins {0};
+    int32_t numLosses {0};
+
+    // Kept on the CPU as well, for drivers without vertex buffer support
+    std::vector<sf::Vertex> vertices;
+    sf::VertexBuffer vertexBuffer {sf::Quads, sf::VertexBuffer::Stream};
+
+    virtual void draw(sf::RenderTarget& target, sf::RenderStates states) const;
+
+    void setTexCoords(int64_t vertex, SpriteType spriteType);
+    bool playMove(Seat& seat);
+    void refresh(int32_t seat);
+
+public:
+    explicit SpectatorGrid(int32_t numBoards);
+
+    // Advances every bot by one move
+    void update();
+
+    std::tuple<uint32_t, uint32_t> getDrawableSize() const;
+
+    inline auto getNumBoards() const
+    {
+        return static_cast<int32_t>(this->seats.size());
+    }
+
+    inline auto getNumWins() const
+    {
+        return this->numWins;
+    }
+
+    inline auto getNumLosses() const
+    {
+        return this->numLosses;
+    }
+};
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+
+// Bounded lock-free queue for exactly one producer thread and one consumer
+//   thread. Capacity must be a power of two.
+template<typename T, size_t Capacity>
+class SpscQueue
+{
+    static_assert((Capacity & (Capacity - 1)) == 0, "Capacity must be a power of two");
+
+private:
+    std::array<T, Capacity> items;
+    // Kept on separate cache lines so the two threads do not contend
+    alignas(64) std::atomic<size_t> head {0};
+    alignas(64) std::atomic<size_t> tail {0};
+
+public:
+    // Producer only. Returns false if the queue is full.
+    bool push(T const& item)
+    {
+        auto tail = this->tail.load(std::memory_order_relaxed);
+        if (tail - this->head.load(std::memory_order_acquire) == Capacity)
+            return false;
+
+        this->items[tail & (Capacity - 1)] = item;
+        this->tail.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Consumer only. Returns false if the queue is empty.
+    bool pop(T& item)
+    {
+        auto head = this->head.load(std::memory_order_relaxed);
+        if (head == this->tail.load(std::memory_order_acquire))
+            return false;
+
+        item = this->items[head & (Capacity - 1)];
+        this->head.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Consumer only
+    bool isEmpty() const
+    {
+        return this->head.load(std::memory_order_relaxed) == this->tail.load(std::memory_order_acquire);
+    }
+};
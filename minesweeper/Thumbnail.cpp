@@ -0,0 +1,150 @@
+#include "Thumbnail.h"
+
+#include "Trace.h"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cmath>
+#include <cstring>
+#include <ranges>
+#include <thread>
+
+bool Thumbnail::saveToFile(std::string const& path) const
+{
+    sf::Image image;
+    image.create(this->width, this->height, this->pixels.data());
+    return image.saveToFile(path);
+}
+
+ThumbnailRenderer::ThumbnailRenderer(int32_t tileSize):
+    tileSize(std::clamp(tileSize, 1, static_cast<int32_t>(TILE_SIZE)))
+{
+    // sf::Image decodes into system memory, so no graphics context is needed
+    sf::Image tileset;
+    tileset.loadFromMemory(minesweeper_tileset.data(), minesweeper_tileset.size());
+    auto const* source = tileset.getPixelsPtr();
+    auto stride        = static_cast<size_t>(tileset.getSize().x) * 4;
+
+    auto size  = this->tileSize;
+    auto scale = static_cast<float>(TILE_SIZE) / size;
+    this->sprites.resize(static_cast<size_t>(NUM_SPRITES) * size * size * 4);
+
+    // Box filter: every output pixel averages the source pixels under it,
+    //   weighted by how much of each it covers. Colours are weighted by alpha
+    //   so transparent pixels don't darken the edges.
+    auto* out = this->sprites.data();
+    for (auto sprite: std::views::iota(0, NUM_SPRITES))
+    {
+        auto rect = TextureManager::getTextureRect(static_cast<SpriteType>(sprite));
+        for (auto oy: std::views::iota(0, size))
+        {
+            auto y0 = oy * scale;
+            auto y1 = (oy + 1) * scale;
+            for (auto ox: std::views::iota(0, size))
+            {
+                auto x0 = ox * scale;
+                auto x1 = (ox + 1) * scale;
+
+                std::array<float, 4> sum {};
+                for (auto sy = static_cast<int32_t>(y0); sy < std::ceil(y1); sy++)
+                {
+                    auto wy = std::min(y1, sy + 1.0f) - std::max(y0, static_cast<float>(sy));
+                    for (auto sx = static_cast<int32_t>(x0); sx < std::ceil(x1); sx++)
+                    {
+                        auto weight    = wy * (std::min(x1, sx + 1.0f) - std::max(x0, static_cast<float>(sx)));
+                        auto const* px = source + (rect.top + sy) * stride + (rect.left + sx) * 4;
+                        auto alpha     = weight * px[3];
+                        sum[0]        += alpha * px[0];
+                        sum[1]        += alpha * px[1];
+                        sum[2]        += alpha * px[2];
+                        sum[3]        += alpha;
+                    }
+                }
+
+                for (auto channel: std::views::iota(0, 3))
+                    *out++ = sum[3] > 0 ? static_cast<uint8_t>(std::lround(sum[channel] / sum[3])) : 0;
+                *out++ = static_cast<uint8_t>(std::lround(sum[3] / (scale * scale)));
+            }
+        }
+    }
+}
+
+int32_t ThumbnailRenderer::fitTileSize(BoardSnapshot const& snapshot, int32_t maxSide)
+{
+    // Hexagonal boards are half a tile wider for the shifted rows
+    auto halfTiles = 2 * snapshot.regionWidth + (snapshot.topology == Topology::HEXAGONAL ? 1 : 0);
+    auto fit       = std::min(2 * maxSide / std::max(halfTiles, 1), maxSide / std::max(snapshot.regionHeight, 1));
+    return std::clamp(fit, 1, static_cast<int32_t>(TILE_SIZE));
+}
+
+void ThumbnailRenderer::render(BoardSnapshot const& snapshot, Thumbnail& thumbnail) const
+{
+    TRACE_SCOPE("ThumbnailRenderer::render");
+    auto size        = this->tileSize;
+    auto hexShift    = snapshot.topology == Topology::HEXAGONAL ? size / 2 : 0;
+    thumbnail.width  = snapshot.regionWidth * size + hexShift;
+    thumbnail.height = snapshot.regionHeight * size;
+
+    // Every pixel is written below, except the gap hexagonal rows leave at one
+    //   end, which is left transparent
+    auto numBytes = static_cast<size_t>(thumbnail.width) * thumbnail.height * 4;
+    if (hexShift > 0)
+        thumbnail.pixels.assign(numBytes, 0);
+    else
+        thumbnail.pixels.resize(numBytes);
+
+    auto rowBytes    = static_cast<size_t>(size) * 4;
+    auto spriteBytes = rowBytes * size;
+    auto lineBytes   = static_cast<size_t>(thumbnail.width) * 4;
+
+    // Each row of tiles is copied one pixel row at a time, so both sides of
+    //   every copy are contiguous and memcpy can move them in vector-wide
+    //   chunks
+    std::vector<uint8_t const*> rowSprites(snapshot.regionWidth);
+    for (auto y: std::views::iota(0, snapshot.regionHeight))
+    {
+        for (auto x: std::views::iota(0, snapshot.regionWidth))
+        {
+            auto tile      = snapshot.tiles[x + y * static_cast<int64_t>(snapshot.regionWidth)];
+            auto detonated = snapshot.lastClickedX == snapshot.regionX + x and
+                             snapshot.lastClickedY == snapshot.regionY + y;
+            auto sprite    = getTileSprite(tile, snapshot.gameState, detonated);
+            rowSprites[x]  = this->sprites.data() + static_cast<size_t>(sprite) * spriteBytes;
+        }
+
+        auto shift = (snapshot.regionY + y) % 2 * hexShift;
+        auto* line = thumbnail.pixels.data() + static_cast<size_t>(y) * size * lineBytes + shift * 4;
+        for (auto row: std::views::iota(0, size))
+        {
+            auto* out = line + row * lineBytes;
+            for (auto const* sprite: rowSprites)
+            {
+                std::memcpy(out, sprite + row * rowBytes, rowBytes);
+                out += rowBytes;
+            }
+        }
+    }
+}
+
+void ThumbnailRenderer::renderBatch(std::span<BoardSnapshot const> snapshots, std::span<Thumbnail> thumbnails,
+                                    int32_t numThreads) const
+{
+    TRACE_SCOPE("ThumbnailRenderer::renderBatch");
+    // Boards can differ a lot in size, so threads take the next one as they
+    //   finish rather than a fixed share each
+    std::atomic<size_t> next {0};
+    auto work = [&]
+    {
+        for (size_t i; (i = next.fetch_add(1, std::memory_order_relaxed)) < snapshots.size();)
+            this->render(snapshots[i], thumbnails[i]);
+    };
+
+    numThreads = std::clamp(numThreads, 1, static_cast<int32_t>(std::max<size_t>(snapshots.size(), 1)));
+    std::vector<std::thread> workers;
+    for ([[maybe_unused]] auto i: std::views::iota(1, numThreads))
+        workers.emplace_back(work);
+    work();
+    for (auto& worker: workers)
+        worker.join();
+}
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <cstdint>
+#include <span>
+#include <string>
+#include <vector>
+
+#include "Minesweeper.h"
+
+// A board drawn into RGBA pixels, row by row
+struct Thumbnail
+{
+    int32_t width {0};
+    int32_t height {0};
+    std::vector<uint8_t> pixels;
+
+    bool saveToFile(std::string const& path) const;
+};
+
+// Draws boards entirely on the CPU, for making images on machines with no GPU
+//   or display. The tileset is decoded once and every sprite scaled down to
+//   the tile size up front, so drawing a board is nothing but row copies.
+class ThumbnailRenderer
+{
+private:
+    static constexpr int32_t NUM_SPRITES {static_cast<int32_t>(SpriteType::UNCOVERED_8) + 1};
+
+    int32_t tileSize;
+    // Every sprite at tileSize, one after another
+    std::vector<uint8_t> sprites;
+
+public:
+    // Tile size is clamped to between 1 and TILE_SIZE pixels
+    explicit ThumbnailRenderer(int32_t tileSize);
+
+    // Largest tile size that fits a snapshot into maxSide pixels each way
+    static int32_t fitTileSize(BoardSnapshot const& snapshot, int32_t maxSide);
+
+    inline auto getTileSize() const
+    {
+        return this->tileSize;
+    }
+
+    // Safe to call from any number of threads at once
+    void render(BoardSnapshot const& snapshot, Thumbnail& thumbnail) const;
+    // Renders snapshots[i] into thumbnails[i], shared between numThreads
+    //   threads
+    void renderBatch(std::span<BoardSnapshot const> snapshots, std::span<Thumbnail> thumbnails,
+                     int32_t numThreads) const;
+};
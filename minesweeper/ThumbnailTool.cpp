@@ -0,0 +1,70 @@
+#include "BitBoard.h"
+#include "Bot.h"
+#include "Minesweeper.h"
+#include "Thumbnail.h"
+
+#include <chrono>
+#include <filesystem>
+#include <iostream>
+#include <random>
+#include <ranges>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Plays expert games with the bot and saves a PNG of every finished board,
+//   without opening a window, so it runs on servers with no GPU or display.
+//   Usage: minesweeper-thumbnails <games> <output directory> [size in pixels]
+int main(int argc, char* argv[])
+{
+    constexpr int32_t DEFAULT_SIZE {256};
+
+    if (argc < 3 or argc > 4)
+    {
+        std::cerr << "Usage: " << argv[0] << " <games> <output directory> [size in pixels]" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    auto numGames = std::stoi(argv[1]);
+    auto outDir   = std::filesystem::path {argv[2]};
+    auto maxSide  = argc == 4 ? std::stoi(argv[3]) : DEFAULT_SIZE;
+    if (numGames <= 0 or maxSide <= 0)
+    {
+        std::cerr << "Games and size must be positive" << std::endl;
+        return EXIT_FAILURE;
+    }
+    std::filesystem::create_directories(outDir);
+
+    std::vector<BoardSnapshot> snapshots(numGames);
+    ExpertBoard board;
+    std::minstd_rand rng {1};
+    for (auto& snapshot: snapshots)
+    {
+        board.initialize();
+        while (playBotMove(board, rng))
+            ;
+        board.publish(snapshot);
+    }
+
+    auto numThreads = static_cast<int32_t>(std::max(std::thread::hardware_concurrency(), 1u));
+    ThumbnailRenderer renderer {ThumbnailRenderer::fitTileSize(snapshots.front(), maxSide)};
+    std::vector<Thumbnail> thumbnails(numGames);
+
+    auto start = std::chrono::steady_clock::now();
+    renderer.renderBatch(snapshots, thumbnails, numThreads);
+    auto seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::cout << "Rendered " << numGames << " boards in " << seconds * 1000 << " ms on " << numThreads
+              << " threads (" << numGames / seconds << " boards/s)" << std::endl;
+
+    for (auto i: std::views::iota(0, numGames))
+    {
+        auto name = "game-" + std::to_string(i + 1) + ".png";
+        if (!thumbnails[i].saveToFile((outDir / name).string()))
+        {
+            std::cerr << "Could not write " << (outDir / name).string() << std::endl;
+            return EXIT_FAILURE;
+        }
+    }
+
+    return EXIT_SUCCESS;
+}
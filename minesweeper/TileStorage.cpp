@@ -0,0 +1,354 @@
+#include "TileStorage.h"
+
+#include "Trace.h"
+
+#include <algorithm>
+#include <iostream>
+#include <random>
+#include <string>
+
+void TileStorage::assign(int64_t count, uint8_t value, int64_t maxResidentBytes)
+{
+    this->stopPaging();
+
+    auto numChunks          = (count + CHUNK_MASK) >> CHUNK_SHIFT;
+    this->count             = count;
+    this->fillValue         = value;
+    this->maxResidentChunks = 0;
+    this->newestChunk       = -1;
+    this->oldestChunk       = -1;
+    this->numResidentChunks = 0;
+    this->cachedChunk       = -1;
+    this->cachedData        = nullptr;
+    this->chunks.resize(numChunks);
+    this->reportedFileError = false;
+    this->evictionStopped   = false;
+
+    if (maxResidentBytes > 0 and count > maxResidentBytes)
+    {
+        std::random_device rd;
+        this->backingPath = std::filesystem::temp_directory_path() /
+                            ("minesweeper-" + std::to_string(rd()) + std::to_string(rd()) + ".tiles");
+        this->backingFile.open(this->backingPath,
+                               std::ios::in | std::ios::out | std::ios::binary | std::ios::trunc);
+        // Without a scratch file there is nothing to page to, so just try to
+        //   hold the whole thing in memory
+        if (this->backingFile.is_open())
+        {
+            this->maxResidentChunks   = std::max<int64_t>(2, maxResidentBytes >> CHUNK_SHIFT);
+            this->maxPrefetchedChunks = std::max(MAX_PENDING_IO, this->maxResidentChunks / 4);
+        }
+    }
+
+    if (this->isPaged())
+    {
+        // Chunks are filled in lazily on first use
+        for (auto& chunk: this->chunks)
+            chunk = Chunk {};
+
+        this->ioStop   = false;
+        this->ioThread = std::thread(&TileStorage::runIo, this);
+        return;
+    }
+
+    // Buffers from the previous board are reused where possible
+    for (auto& chunk: this->chunks)
+    {
+        if (!chunk.data)
+            chunk.data = std::make_unique<uint8_t[]>(CHUNK_SIZE);
+        std::fill_n(chunk.data.get(), CHUNK_SIZE, value);
+    }
+}
+
+bool TileStorage::prefetch(int64_t begin, int64_t end) const
+{
+    if (!this->isPaged())
+        return false;
+
+    begin = std::clamp<int64_t>(begin, 0, this->count);
+    end   = std::clamp<int64_t>(end, 0, this->count);
+
+    // Resident and never written chunks need no reading, and the lock is only
+    //   taken once there is something to queue
+    std::unique_lock lock {this->ioMutex, std::defer_lock};
+    auto room = true;
+    for (auto chunk = begin >> CHUNK_SHIFT; chunk < (end + CHUNK_MASK) >> CHUNK_SHIFT; ++chunk)
+    {
+        auto const& entry = this->chunks[chunk];
+        if (entry.data or !entry.onDisk)
+            continue;
+
+        if (!lock.owns_lock())
+            lock.lock();
+        if (this->ioQueue.size() >= MAX_PENDING_IO or
+            this->ioQueue.size() + this->prefetched.size() >= this->maxPrefetchedChunks)
+        {
+            room = false;
+            break;
+        }
+        if (entry.hasIoTask)
+            continue;
+
+        entry.hasIoTask = true;
+        this->ioQueue.push_back({false, chunk, entry.epoch, nullptr});
+    }
+
+    if (lock.owns_lock())
+        this->ioCondition.notify_all();
+    return room;
+}
+
+void TileStorage::fault(int64_t chunk, bool writable)
+{
+    auto& entry = this->chunks[chunk];
+    if (!entry.data)
+        this->pageIn(chunk);
+    else if (this->isPaged() and chunk != this->newestChunk)
+    {
+        this->unlink(chunk);
+        this->linkNewest(chunk);
+    }
+
+    entry.dirty |= writable;
+
+    this->cachedChunk    = chunk;
+    this->cachedData     = entry.data.get();
+    this->cachedWritable = writable;
+}
+
+void TileStorage::pageIn(int64_t chunk)
+{
+    TRACE_SCOPE("TileStorage::pageIn");
+    if (this->numResidentChunks >= this->maxResidentChunks and this->canEvict())
+        this->evictOne();
+
+    auto& entry = this->chunks[chunk];
+    entry.data  = this->reclaim(chunk);
+    if (!entry.data)
+    {
+        entry.data = std::make_unique<uint8_t[]>(CHUNK_SIZE);
+        // A chunk that cannot be read back is gone, so it starts over as fresh
+        //   storage rather than holding whatever the failed read left behind
+        if (!entry.onDisk or !this->readChunk(chunk, entry.data.get()))
+            std::fill_n(entry.data.get(), CHUNK_SIZE, this->fillValue);
+    }
+
+    this->linkNewest(chunk);
+    this->numResidentChunks++;
+}
+
+bool TileStorage::canEvict()
+{
+    if (this->evictionStopped)
+        return false;
+
+    // Every failed write keeps its chunk in memory, so evicting more only
+    //   trades resident chunks for unwritten ones while hammering the disk
+    std::lock_guard lock {this->ioMutex};
+    if (this->unwritten.size() < this->maxResidentChunks)
+        return true;
+
+    std::cerr << "Paging to " << this->backingPath.string()
+              << " keeps failing, keeping everything in memory from now on" << std::endl;
+    this->evictionStopped = true;
+    return false;
+}
+
+void TileStorage::evictOne()
+{
+    auto chunk = this->oldestChunk;
+    this->unlink(chunk);
+    this->numResidentChunks--;
+
+    if (this->cachedChunk == chunk)
+        this->cachedChunk = -1;
+
+    auto& entry = this->chunks[chunk];
+    entry.epoch++;
+    if (!entry.dirty and entry.onDisk)
+    {
+        entry.data.reset();
+        return;
+    }
+
+    std::unique_lock lock {this->ioMutex};
+    this->ioCondition.wait(lock, [this] { return this->ioQueue.size() < MAX_PENDING_IO; });
+    this->ioQueue.push_back({true, chunk, entry.epoch, std::move(entry.data)});
+    entry.hasIoTask = true;
+    this->ioCondition.notify_all();
+    entry.dirty  = false;
+    entry.onDisk = true;
+}
+
+void TileStorage::linkNewest(int64_t chunk)
+{
+    auto& entry = this->chunks[chunk];
+    entry.newer = -1;
+    entry.older = this->newestChunk;
+    if (this->newestChunk != -1)
+        this->chunks[this->newestChunk].newer = chunk;
+    else
+        this->oldestChunk = chunk;
+    this->newestChunk = chunk;
+}
+
+void TileStorage::unlink(int64_t chunk)
+{
+    auto& entry = this->chunks[chunk];
+    if (entry.newer != -1)
+        this->chunks[entry.newer].older = entry.older;
+    else
+        this->newestChunk = entry.older;
+    if (entry.older != -1)
+        this->chunks[entry.older].newer = entry.newer;
+    else
+        this->oldestChunk = entry.newer;
+    entry.newer = -1;
+    entry.older = -1;
+}
+
+std::unique_ptr<uint8_t[]> TileStorage::reclaim(int64_t chunk)
+{
+    std::unique_lock lock {this->ioMutex};
+    this->ioCondition.wait(lock, [this, chunk] { return this->ioInFlightChunk != chunk; });
+
+    auto& entry = this->chunks[chunk];
+    if (!entry.hasIoTask)
+        return nullptr;
+    entry.hasIoTask = false;
+
+    // A write that has not happened yet, or that failed, still holds the
+    //   newest contents
+    auto isWrite = [chunk](IoTask const& task) { return task.write and task.chunk == chunk; };
+    if (auto pending = std::ranges::find_if(this->ioQueue, isWrite); pending != this->ioQueue.end())
+    {
+        auto data = std::move(pending->data);
+        this->ioQueue.erase(pending);
+        entry.dirty = true;
+        return data;
+    }
+    if (auto failed = std::ranges::find_if(this->unwritten, isWrite); failed != this->unwritten.end())
+    {
+        auto data = std::move(failed->data);
+        this->unwritten.erase(failed);
+        entry.dirty = true;
+        return data;
+    }
+
+    // A read still queued is no longer needed
+    std::erase_if(this->ioQueue, [chunk](IoTask const& task) { return task.chunk == chunk; });
+    std::unique_ptr<uint8_t[]> data;
+    auto epoch = entry.epoch;
+    std::erase_if(this->prefetched,
+                  [&data, chunk, epoch](IoTask& task)
+                  {
+                      if (task.chunk != chunk)
+                          return false;
+                      if (task.epoch == epoch)
+                          data = std::move(task.data);
+                      return true;
+                  });
+
+    return data;
+}
+
+bool TileStorage::readChunk(int64_t chunk, uint8_t* data)
+{
+    TRACE_SCOPE("TileStorage::readChunk");
+    std::lock_guard lock {this->fileMutex};
+    this->backingFile.seekg(chunk << CHUNK_SHIFT);
+    this->backingFile.read(reinterpret_cast<char*>(data), CHUNK_SIZE);
+    if (this->backingFile.good() and this->backingFile.gcount() == CHUNK_SIZE)
+        return true;
+
+    if (!this->reportedFileError)
+        std::cerr << "Could not read chunk " << chunk << " of " << this->backingPath.string() << std::endl;
+    this->reportedFileError = true;
+    // Later chunks may still be readable
+    this->backingFile.clear();
+    return false;
+}
+
+bool TileStorage::writeChunk(int64_t chunk, uint8_t const* data)
+{
+    TRACE_SCOPE("TileStorage::writeChunk");
+    std::lock_guard lock {this->fileMutex};
+    this->backingFile.seekp(chunk << CHUNK_SHIFT);
+    this->backingFile.write(reinterpret_cast<char const*>(data), CHUNK_SIZE);
+    if (this->backingFile.good())
+        return true;
+
+    if (!this->reportedFileError)
+        std::cerr << "Could not write chunk " << chunk << " to " << this->backingPath.string() << std::endl;
+    this->reportedFileError = true;
+    this->backingFile.clear();
+    return false;
+}
+
+void TileStorage::runIo()
+{
+    Tracer::setThreadName("Tile I/O");
+    std::unique_lock lock {this->ioMutex};
+    while (true)
+    {
+        this->ioCondition.wait(lock, [this] { return this->ioStop or !this->ioQueue.empty(); });
+        if (this->ioStop)
+            return;
+
+        auto task = std::move(this->ioQueue.front());
+        this->ioQueue.pop_front();
+        this->ioInFlightChunk = task.chunk;
+        lock.unlock();
+
+        bool succeeded;
+        if (task.write)
+            succeeded = this->writeChunk(task.chunk, task.data.get());
+        else
+        {
+            task.data = std::make_unique<uint8_t[]>(CHUNK_SIZE);
+            succeeded = this->readChunk(task.chunk, task.data.get());
+        }
+
+        lock.lock();
+        this->ioInFlightChunk = -1;
+        if (task.write and !succeeded)
+            this->unwritten.push_back(std::move(task));
+        else if (!task.write and succeeded)
+        {
+            this->prefetched.push_back(std::move(task));
+            if (this->prefetched.size() > this->maxPrefetchedChunks)
+            {
+                this->chunks[this->prefetched.front().chunk].hasIoTask = false;
+                this->prefetched.erase(this->prefetched.begin());
+            }
+        }
+        else
+            this->chunks[task.chunk].hasIoTask = false;
+        this->ioCondition.notify_all();
+    }
+}
+
+void TileStorage::stopPaging()
+{
+    if (this->ioThread.joinable())
+    {
+        {
+            std::lock_guard lock {this->ioMutex};
+            this->ioStop = true;
+        }
+        this->ioCondition.notify_all();
+        this->ioThread.join();
+    }
+
+    this->ioQueue.clear();
+    this->prefetched.clear();
+    this->unwritten.clear();
+    this->ioInFlightChunk = -1;
+
+    if (this->backingFile.is_open())
+    {
+        this->backingFile.close();
+        std::error_code ec;
+        std::filesystem::remove(this->backingPath, ec);
+    }
+}
@@ -0,0 +1,155 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Byte array split into fixed-size chunks. Small arrays keep every chunk in
+//   memory. Large ones are backed by a scratch file, with at most
+//   maxResidentChunks chunks cached in memory; the least recently used chunk
+//   is paged out when a new one is needed. Dirty chunks are written back and
+//   prefetched chunks are read in by a background thread. Chunks that fail to
+//   write are kept in memory rather than lost; once a cache's worth of them
+//   has piled up, paging stops and the rest of the array stays in memory too.
+//   Failures are reported on std::cerr.
+class TileStorage
+{
+public:
+    static constexpr int32_t CHUNK_SHIFT {16};
+    static constexpr int64_t CHUNK_SIZE {int64_t {1} << CHUNK_SHIFT};
+    static constexpr int64_t CHUNK_MASK {CHUNK_SIZE - 1};
+
+private:
+    struct Chunk
+    {
+        std::unique_ptr<uint8_t[]> data;
+        // Neighbours in the list of resident chunks, or -1 at either end
+        int64_t newer {-1};
+        int64_t older {-1};
+        // Bumped every time the chunk is paged out, so prefetches that raced
+        //   with an eviction can be recognised as stale
+        uint32_t epoch {0};
+        bool dirty {false};
+        bool onDisk {false};
+        // Guarded by ioMutex. Set while the chunk has a task queued, in
+        //   flight, prefetched or unwritten, so prefetch can pass over it
+        //   without searching those lists.
+        mutable bool hasIoTask {false};
+    };
+
+    // Pending writes and prefetches are capped so that paging stays within a
+    //   small multiple of the cache size
+    static constexpr size_t MAX_PENDING_IO {64};
+
+    struct IoTask
+    {
+        bool write;
+        int64_t chunk;
+        uint32_t epoch;
+        std::unique_ptr<uint8_t[]> data;
+    };
+
+    int64_t count {0};
+    uint8_t fillValue {0};
+    size_t maxResidentChunks {0};
+    // Chunks read ahead and not yet used, kept to a quarter of the cache
+    size_t maxPrefetchedChunks {0};
+
+    std::vector<Chunk> chunks;
+    // Resident chunks of a paged storage, linked from most to least recently
+    //   used, so finding the chunk to evict takes constant time
+    int64_t newestChunk {-1};
+    int64_t oldestChunk {-1};
+    size_t numResidentChunks {0};
+
+    // Last chunk touched, so runs of accesses within one chunk skip the
+    //   lookup entirely
+    int64_t cachedChunk {-1};
+    uint8_t* cachedData {nullptr};
+    bool cachedWritable {false};
+
+    // Everything below is only used once the storage is paged
+    std::filesystem::path backingPath;
+    std::fstream backingFile;
+    std::mutex fileMutex;
+    // A failing disk tends to fail every access, so only the first is reported
+    bool reportedFileError {false};
+    bool evictionStopped {false};
+
+    // Prefetching leaves the contents alone, so it is allowed on const storage
+    std::thread ioThread;
+    mutable std::mutex ioMutex;
+    mutable std::condition_variable ioCondition;
+    mutable std::deque<IoTask> ioQueue;
+    std::vector<IoTask> prefetched;
+    // Writes that failed, holding the only copy of their chunk
+    std::vector<IoTask> unwritten;
+    int64_t ioInFlightChunk {-1};
+    bool ioStop {false};
+
+    void fault(int64_t chunk, bool writable);
+    void pageIn(int64_t chunk);
+    bool canEvict();
+    void evictOne();
+    void linkNewest(int64_t chunk);
+    void unlink(int64_t chunk);
+    std::unique_ptr<uint8_t[]> reclaim(int64_t chunk);
+    bool readChunk(int64_t chunk, uint8_t* data);
+    bool writeChunk(int64_t chunk, uint8_t const* data);
+    void runIo();
+    void stopPaging();
+
+public:
+    TileStorage() = default;
+    TileStorage(TileStorage const&)     = delete;
+    void operator=(TileStorage const&) = delete;
+
+    ~TileStorage()
+    {
+        this->stopPaging();
+    }
+
+    // Resets the storage to count bytes holding value. Arrays larger than
+    //   maxResidentBytes are paged to disk; pass 0 to always keep them in memory.
+    void assign(int64_t count, uint8_t value, int64_t maxResidentBytes = 0);
+
+    // Queues the chunks covering [begin, end) to be read in ahead of use.
+    //   False once no more reads can be queued for now, so callers walking
+    //   a large area can stop early.
+    bool prefetch(int64_t begin, int64_t end) const;
+
+    inline auto size() const
+    {
+        return this->count;
+    }
+
+    inline auto isPaged() const
+    {
+        return this->maxResidentChunks != 0;
+    }
+
+    inline uint8_t operator[](int64_t index) const
+    {
+        // Paging a chunk in does not change the contents, so reads stay const
+        auto chunk = index >> CHUNK_SHIFT;
+        if (chunk != this->cachedChunk)
+            const_cast<TileStorage*>(this)->fault(chunk, false);
+
+        return this->cachedData[index & CHUNK_MASK];
+    }
+
+    inline uint8_t& operator[](int64_t index)
+    {
+        auto chunk = index >> CHUNK_SHIFT;
+        if (chunk != this->cachedChunk or !this->cachedWritable)
+            this->fault(chunk, true);
+
+        return this->cachedData[index & CHUNK_MASK];
+    }
+};
@@ -0,0 +1,101 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <utility>
+
+enum class Topology : uint8_t
+{
+    SQUARE,
+    TORUS,
+    HEXAGONAL,
+};
+
+// Shape of the padded tile array: tile (x, y) lives at (x + 1) + (y + 1) * stride
+struct BoardGeometry
+{
+    int32_t width;
+    int32_t height;
+    int32_t stride;
+};
+
+// Each topology lists its neighbours as compile time (dx, dy) offsets and
+//   walks them with a fold expression, so the loop is fully unrolled and
+//   none of the variants branch per neighbour.
+
+// Square grid with walls -- the border tiles stop every walk
+struct SquareTopology
+{
+    static constexpr std::array<std::array<int32_t, 2>, 8> OFFSETS {{
+        {-1, -1},
+        { 0, -1},
+        { 1, -1},
+        {-1,  0},
+        { 1,  0},
+        {-1,  1},
+        { 0,  1},
+        { 1,  1},
+    }};
+
+    template<typename Fn>
+    static inline void forEachNeighbour(BoardGeometry geometry, int64_t index, Fn&& fn)
+    {
+        [&]<size_t... I>(std::index_sequence<I...>)
+        {
+            (fn(index + OFFSETS[I][0] + OFFSETS[I][1] * static_cast<int64_t>(geometry.stride)), ...);
+        }(std::make_index_sequence<OFFSETS.size()>());
+    }
+};
+
+// Square grid where the edges wrap around to the opposite side
+struct TorusTopology
+{
+    static constexpr auto OFFSETS {SquareTopology::OFFSETS};
+
+    template<typename Fn>
+    static inline void forEachNeighbour(BoardGeometry geometry, int64_t index, Fn&& fn)
+    {
+        auto x = static_cast<int32_t>(index % geometry.stride) - 1;
+        auto y = static_cast<int32_t>(index / geometry.stride) - 1;
+        [&]<size_t... I>(std::index_sequence<I...>)
+        {
+            (fn(wrap(x + OFFSETS[I][0], geometry.width) + 1 +
+                (wrap(y + OFFSETS[I][1], geometry.height) + 1) * static_cast<int64_t>(geometry.stride)),
+             ...);
+        }(std::make_index_sequence<OFFSETS.size()>());
+    }
+
+private:
+    static constexpr int32_t wrap(int32_t value, int32_t size)
+    {
+        return value + (value < 0) * size - (value >= size) * size;
+    }
+};
+
+// Hexagonal grid in "odd-r" layout: odd rows are drawn shifted right by half
+//   a tile, so the diagonal neighbours move one column to the right on those
+//   rows. Walls work the same as the square grid.
+struct HexTopology
+{
+    static constexpr std::array<std::array<int32_t, 2>, 6> OFFSETS {{
+        {-1, -1},
+        { 0, -1},
+        {-1,  0},
+        { 1,  0},
+        {-1,  1},
+        { 0,  1},
+    }};
+
+    template<typename Fn>
+    static inline void forEachNeighbour(BoardGeometry geometry, int64_t index, Fn&& fn)
+    {
+        // Only the diagonals pick up the row shift
+        auto shift = static_cast<int32_t>(index / geometry.stride - 1) & 1;
+        [&]<size_t... I>(std::index_sequence<I...>)
+        {
+            (fn(index + OFFSETS[I][0] + (OFFSETS[I][1] != 0) * shift +
+                OFFSETS[I][1] * static_cast<int64_t>(geometry.stride)),
+             ...);
+        }(std::make_index_sequence<OFFSETS.size()>());
+    }
+};
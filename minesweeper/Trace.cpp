@@ -0,0 +1,145 @@
+#include "Trace.h"
+
+#include "Minesweeper.h"
+
+#include <fstream>
+#include <iomanip>
+
+Tracer& Tracer::getInstance()
+{
+    static Tracer instance;
+
+    return instance;
+}
+
+thread_local Tracer::ThreadBufferOwner Tracer::threadBuffer;
+
+Tracer::ThreadBufferOwner::~ThreadBufferOwner()
+{
+    if (this->buffer)
+        Tracer::getInstance().releaseThreadBuffer(*this->buffer);
+}
+
+Tracer::ThreadBuffer& Tracer::getThreadBuffer()
+{
+    if (!threadBuffer.buffer)
+    {
+        std::lock_guard lock {this->registryMutex};
+        auto& buffer        = this->buffers.emplace_back(std::make_unique<ThreadBuffer>());
+        buffer->threadId    = this->nextThreadId++;
+        threadBuffer.buffer = buffer.get();
+    }
+
+    return *threadBuffer.buffer;
+}
+
+void Tracer::releaseThreadBuffer(ThreadBuffer& buffer)
+{
+    std::lock_guard lock {this->registryMutex};
+    buffer.exited = true;
+    this->freeExitedBuffers();
+}
+
+void Tracer::freeExitedBuffers()
+{
+    std::erase_if(this->buffers,
+                  [this](std::unique_ptr<ThreadBuffer> const& buffer)
+                  {
+                      if (!buffer->exited or !buffer->ring.isEmpty())
+                          return false;
+                      if (buffer->threadName)
+                          this->exitedThreadNames.emplace_back(buffer->threadId, buffer->threadName);
+                      this->exitedDropped += buffer->dropped.load(std::memory_order_relaxed);
+                      return true;
+                  });
+}
+
+void Tracer::setThreadName(char const* name)
+{
+    auto& tracer = getInstance();
+    auto& buffer = tracer.getThreadBuffer();
+    std::lock_guard lock {tracer.registryMutex};
+    buffer.threadName = name;
+}
+
+void Tracer::record(char const* name, int64_t begin, int64_t end)
+{
+    auto& buffer = this->getThreadBuffer();
+    if (!buffer.ring.push({name, begin, end}))
+        buffer.dropped.fetch_add(1, std::memory_order_relaxed);
+}
+
+void Tracer::start()
+{
+    consoleLog("Tracing started");
+    // Spans that were still open when the last trace stopped are thrown away
+    this->collect();
+    this->collected.clear();
+    {
+        std::lock_guard lock {this->registryMutex};
+        this->exitedThreadNames.clear();
+        this->exitedDropped = 0;
+    }
+    enabled.store(true, std::memory_order_relaxed);
+}
+
+void Tracer::collect()
+{
+    std::lock_guard lock {this->registryMutex};
+    Event event;
+    for (auto const& buffer: this->buffers)
+        while (buffer->ring.pop(event))
+            this->collected.push_back({event, buffer->threadId});
+    this->freeExitedBuffers();
+}
+
+void Tracer::stop(std::filesystem::path const& path)
+{
+    enabled.store(false, std::memory_order_relaxed);
+    this->collect();
+
+    // Timestamps are in microseconds, with fractions kept for short spans
+    std::ofstream file {path};
+    file << std::fixed << std::setprecision(3) << "{\"traceEvents\":[\n";
+    bool first = true;
+    auto separate = [&]()
+    {
+        if (!first)
+            file << ",\n";
+        first = false;
+    };
+
+    auto writeThreadName = [&](int32_t threadId, char const* name)
+    {
+        separate();
+        file << R"({"name":"thread_name","ph":"M","pid":1,"tid":)" << threadId << R"(,"args":{"name":")" << name
+             << "\"}}";
+    };
+
+    uint64_t dropped = 0;
+    {
+        std::lock_guard lock {this->registryMutex};
+        for (auto const& buffer: this->buffers)
+        {
+            dropped += buffer->dropped.exchange(0, std::memory_order_relaxed);
+            if (buffer->threadName)
+                writeThreadName(buffer->threadId, buffer->threadName);
+        }
+        for (auto const& [threadId, name]: this->exitedThreadNames)
+            writeThreadName(threadId, name);
+        dropped += std::exchange(this->exitedDropped, 0);
+    }
+
+    for (auto const& [event, threadId]: this->collected)
+    {
+        separate();
+        file << R"({"name":")" << event.name << R"(","ph":"X","pid":1,"tid":)" << threadId
+             << ",\"ts\":" << event.begin / 1000.0 << ",\"dur\":" << (event.end - event.begin) / 1000.0 << '}';
+    }
+    file << "\n]}\n";
+
+    consoleLog("Wrote " + std::to_string(this->collected.size()) + " trace events to " + path.string());
+    if (dropped != 0)
+        consoleLog(std::to_string(dropped) + " trace events were dropped");
+    this->collected.clear();
+}
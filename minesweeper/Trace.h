@@ -0,0 +1,139 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+#include "SpscQueue.h"
+
+// Spans are recorded into a ring buffer per thread and collected by one
+//   thread into a Chrome trace-event file, which chrome://tracing and Perfetto
+//   can open. While tracing is off a span costs one relaxed load.
+class Tracer
+{
+private:
+    struct Event
+    {
+        char const* name;
+        int64_t begin;
+        int64_t end;
+    };
+
+    static constexpr size_t RING_CAPACITY {size_t {1} << 14};
+
+    struct ThreadBuffer
+    {
+        SpscQueue<Event, RING_CAPACITY> ring;
+        // Guarded by registryMutex, as the collecting thread reads it
+        char const* threadName {nullptr};
+        int32_t threadId;
+        // Events lost because the ring was full when they were recorded
+        std::atomic<uint64_t> dropped {0};
+        // Set once the thread has exited, so the ring is freed after its
+        //   last events are collected
+        bool exited {false};
+    };
+
+    // Hands the thread's ring back to the tracer when the thread exits
+    struct ThreadBufferOwner
+    {
+        ThreadBuffer* buffer {nullptr};
+
+        ~ThreadBufferOwner();
+    };
+
+    struct CollectedEvent
+    {
+        Event event;
+        int32_t threadId;
+    };
+
+    static inline std::atomic<bool> enabled {false};
+    static thread_local ThreadBufferOwner threadBuffer;
+
+    // A ring is freed once its thread has exited and everything in it has
+    //   been collected, so threads that come and go do not add up. Their names
+    //   and drop counts are kept until the next trace starts.
+    std::mutex registryMutex;
+    std::vector<std::unique_ptr<ThreadBuffer>> buffers;
+    std::vector<std::pair<int32_t, char const*>> exitedThreadNames;
+    uint64_t exitedDropped {0};
+    int32_t nextThreadId {1};
+    std::chrono::steady_clock::time_point epoch {std::chrono::steady_clock::now()};
+
+    // Only touched by the collecting thread
+    std::vector<CollectedEvent> collected;
+
+    Tracer() = default;
+
+    ThreadBuffer& getThreadBuffer();
+    void releaseThreadBuffer(ThreadBuffer& buffer);
+    // Frees the rings of exited threads that have nothing left to collect.
+    //   Needs the registry lock.
+    void freeExitedBuffers();
+
+public:
+    Tracer(Tracer const&)         = delete;
+    void operator=(Tracer const&) = delete;
+
+    static Tracer& getInstance();
+
+    static inline bool isEnabled()
+    {
+        return enabled.load(std::memory_order_relaxed);
+    }
+
+    inline int64_t now() const
+    {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - this->epoch)
+            .count();
+    }
+
+    // Names the calling thread in the trace. name must outlive the tracer.
+    //   Named threads get their ring here, so recording never allocates on
+    //   them; other threads get one the first time they record something.
+    static void setThreadName(char const* name);
+
+    void record(char const* name, int64_t begin, int64_t end);
+
+    void start();
+    // Moves everything recorded so far out of the rings. Call it regularly
+    //   from one thread while tracing so that the rings do not overflow.
+    void collect();
+    // Stops tracing and writes out everything collected since start
+    void stop(std::filesystem::path const& path);
+};
+
+class TraceScope
+{
+private:
+    char const* name;
+    int64_t begin;
+
+public:
+    explicit TraceScope(char const* name): name(name), begin(Tracer::isEnabled() ? Tracer::getInstance().now() : -1)
+    {
+    }
+
+    TraceScope(TraceScope const&)     = delete;
+    void operator=(TraceScope const&) = delete;
+
+    ~TraceScope()
+    {
+        if (this->begin >= 0)
+        {
+            auto& tracer = Tracer::getInstance();
+            tracer.record(this->name, this->begin, tracer.now());
+        }
+    }
+};
+
+#define TRACE_CONCAT_INNER(a, b) a##b
+#define TRACE_CONCAT(a, b)       TRACE_CONCAT_INNER(a, b)
+// Records a span from here to the end of the enclosing block
+#define TRACE_SCOPE(name) TraceScope TRACE_CONCAT(traceScope, __LINE__)(name)
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+// Hands values from one writer thread to one reader thread without locking.
+//   The writer fills the back buffer and publishes it; the reader picks up the
+//   most recent published buffer and keeps reading it until it asks for a new
+//   one. Neither side ever waits for the other.
+template<typename T>
+class TripleBuffer
+{
+private:
+    // Set on the middle index when it holds a value the reader has not seen
+    static constexpr uint8_t FRESH_BIT {0x4};
+
+    std::array<T, 3> buffers;
+    std::atomic<uint8_t> middle {1};
+    uint8_t back {0};
+    uint8_t front {2};
+
+public:
+    // Writer only
+    T& getBack()
+    {
+        return this->buffers[this->back];
+    }
+
+    // Writer only. The new back buffer holds an older value and must be
+    //   overwritten in full before the next publish.
+    void publish()
+    {
+        this->back = this->middle.exchange(this->back | FRESH_BIT, std::memory_order_acq_rel) & ~FRESH_BIT;
+    }
+
+    // Reader only. Returns true if a newer value was picked up.
+    bool update()
+    {
+        if (!(this->middle.load(std::memory_order_relaxed) & FRESH_BIT))
+            return false;
+
+        this->front = this->middle.exchange(this->front, std::memory_order_acq_rel) & ~FRESH_BIT;
+        return true;
+    }
+
+    // Reader only
+    T const& getFront() const
+    {
+        return this->buffers[this->front];
+    }
+};
@@ -0,0 +1,86 @@
+#include "AllocationCounter.h"
+#include "Minesweeper.h"
+#include "Trace.h"
+
+#include "Check.h"
+
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <random>
+#include <ranges>
+#include <thread>
+
+// Plays a game of random clicks, checking that no input makes the board
+//   allocate once it has played a game before
+static void playGame(GameBoard& board, std::mt19937& rng, bool checkAllocations)
+{
+    auto [boardWidth, boardHeight, mineCount] = board.getBoardConfig();
+    std::uniform_real_distribution<float> pickX {0, static_cast<float>(boardWidth)};
+    std::uniform_real_distribution<float> pickY {0, static_cast<float>(boardHeight)};
+
+    for (auto move = 0; move < 10000; move++)
+    {
+        auto state = board.getGameState();
+        if (state == GameState::GAME_WON or state == GameState::GAME_LOST)
+            break;
+
+        auto button = move % 5 == 4 ? sf::Mouse::Button::Right : sf::Mouse::Button::Left;
+        AllocationScope scope;
+        board.telegraph(pickX(rng), pickY(rng));
+        board.clearTelegraph();
+        board.interact(pickX(rng), pickY(rng), button);
+        while (board.advanceReveal(64))
+            ;
+        if (checkAllocations)
+            CHECK(scope.getCount() == 0);
+    }
+}
+
+int main()
+{
+    std::mt19937 rng {1};
+    for (auto topology: {Topology::SQUARE, Topology::TORUS, Topology::HEXAGONAL})
+    {
+        GameBoard board {30, 16, 99, topology};
+        playGame(board, rng, false);
+        for ([[maybe_unused]] auto game: std::views::iota(0, 20))
+        {
+            board.initialize();
+            playGame(board, rng, true);
+        }
+    }
+
+    // Nor does tracing, on a thread that names itself the way the simulation
+    //   thread does before its first move
+    {
+        GameBoard board {30, 16, 99};
+        playGame(board, rng, false);
+        board.initialize();
+
+        auto path = std::filesystem::temp_directory_path() / "minesweeper-allocation-test.json";
+        Tracer::getInstance().start();
+        std::thread thread {[&]
+                            {
+                                Tracer::setThreadName("Test");
+                                playGame(board, rng, true);
+                            }};
+        thread.join();
+        Tracer::getInstance().stop(path);
+        std::filesystem::remove(path);
+    }
+
+    // Over-aligned types go through their own operator new
+    struct alignas(64) Aligned
+    {
+        char bytes[64];
+    };
+    AllocationScope scope;
+    auto aligned = std::make_unique<Aligned>();
+    auto array   = std::make_unique<Aligned[]>(3);
+    CHECK(scope.getCount() == 2);
+    CHECK(reinterpret_cast<uintptr_t>(aligned.get()) % 64 == 0);
+    CHECK(reinterpret_cast<uintptr_t>(array.get()) % 64 == 0);
+
+    return testResult();
+}
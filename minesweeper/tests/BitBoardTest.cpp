@@ -0,0 +1,215 @@
+#include "BitBoard.h"
+#include "Bot.h"
+#include "Minesweeper.h"
+
+#include "Check.h"
+
+#include <algorithm>
+#include <bit>
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <random>
+#include <ranges>
+#include <vector>
+
+// Lets the bot play from a snapshot, so it plays GameBoard and BitBoard alike
+template<int32_t Width, int32_t Height>
+struct SnapshotView
+{
+    static constexpr int32_t BOARD_WIDTH {Width};
+    static constexpr int32_t BOARD_HEIGHT {Height};
+
+    BoardSnapshot const& snapshot;
+
+    uint8_t getTile(int32_t x, int32_t y) const
+    {
+        return this->snapshot.tiles[x + y * Width];
+    }
+
+    GameState getGameState() const
+    {
+        return this->snapshot.gameState;
+    }
+
+    TileState getTileState(int32_t x, int32_t y) const
+    {
+        return static_cast<TileState>((this->getTile(x, y) & TILE_STATE_MASK) >> TILE_STATE_SHIFT);
+    }
+
+    int32_t getMineCount(int32_t x, int32_t y) const
+    {
+        return this->getTile(x, y) & TILE_COUNT_MASK;
+    }
+
+    bool isMine(int32_t x, int32_t y) const
+    {
+        return this->getTile(x, y) & TILE_MINE_BIT;
+    }
+};
+
+using ExpertView = SnapshotView<ExpertBoard::BOARD_WIDTH, ExpertBoard::BOARD_HEIGHT>;
+
+template<typename Fn>
+static void forEachNeighbour(int32_t x, int32_t y, Fn&& fn)
+{
+    for (auto ny: std::views::iota(std::max(y - 1, 0), std::min(y + 2, ExpertView::BOARD_HEIGHT)))
+        for (auto nx: std::views::iota(std::max(x - 1, 0), std::min(x + 2, ExpertView::BOARD_WIDTH)))
+            if (nx != x or ny != y)
+                fn(nx, ny);
+}
+
+// Checks a published position against the rules, working only from the
+//   mines in the snapshot
+static void checkRules(ExpertView const& view)
+{
+    int32_t numMines       = 0;
+    int32_t numCoveredSafe = 0;
+    bool mineUncovered     = false;
+    for (auto y: std::views::iota(0, ExpertView::BOARD_HEIGHT))
+    {
+        for (auto x: std::views::iota(0, ExpertView::BOARD_WIDTH))
+        {
+            int32_t around = 0;
+            forEachNeighbour(x, y, [&](int32_t nx, int32_t ny) { around += view.isMine(nx, ny); });
+            auto state = view.getTileState(x, y);
+            if (view.isMine(x, y))
+            {
+                numMines++;
+                mineUncovered |= state == TileState::UNCOVERED;
+                continue;
+            }
+
+            CHECK(view.getMineCount(x, y) == around);
+            if (state != TileState::UNCOVERED)
+                numCoveredSafe++;
+            // Openings are always opened all the way
+            else if (around == 0)
+                forEachNeighbour(x, y, [&](int32_t nx, int32_t ny)
+                                 { CHECK(view.getTileState(nx, ny) != TileState::COVERED); });
+        }
+    }
+
+    CHECK(numMines == ExpertBoard::MINE_COUNT);
+    CHECK(mineUncovered == (view.getGameState() == GameState::GAME_LOST));
+    if (!mineUncovered)
+        CHECK((numCoveredSafe == 0) == (view.getGameState() == GameState::GAME_WON));
+}
+
+// Every covered tile the position leaves open must be counted, and every
+//   number must match the mines actually under its tiles
+static void checkEndgame(ExpertView const& view, EndgamePosition const& position)
+{
+    int32_t minesLeft = 0;
+    for (auto const& tile: position.tiles)
+    {
+        CHECK(view.getTileState(tile.x, tile.y) != TileState::UNCOVERED);
+        minesLeft += view.isMine(tile.x, tile.y);
+    }
+    CHECK(minesLeft == position.minesLeft);
+
+    for (auto const& constraint: position.constraints)
+    {
+        int32_t mines = 0;
+        for (auto bits = constraint.tiles; bits; bits &= bits - 1)
+        {
+            auto const& tile = position.tiles[std::countr_zero(bits)];
+            mines += view.isMine(tile.x, tile.y);
+        }
+        CHECK(mines == constraint.mines);
+    }
+}
+
+// Plays bot games on a BitBoard, checking every position it publishes and
+//   that its deltas rebuild what the player sees
+static void checkGames(int32_t numGames)
+{
+    std::mt19937 rng {1};
+    ExpertBoard board;
+    board.setRecordingChanges(true);
+    BoardSnapshot snapshot;
+    BoardDelta delta;
+    EndgamePosition position;
+    ExpertView view {snapshot};
+
+    for ([[maybe_unused]] auto game: std::views::iota(0, numGames))
+    {
+        board.initialize();
+        board.publish(snapshot);
+        std::vector<uint8_t> seen(snapshot.tiles.size(), packTileState(TileState::COVERED));
+
+        while (auto move = chooseBotMove(view, rng))
+        {
+            auto firstMove = snapshot.gameState == GameState::GAME_NOT_STARTED;
+            board.interact(static_cast<float>(move->x), static_cast<float>(move->y), move->button);
+            board.publish(snapshot);
+            checkRules(view);
+            if (firstMove)
+                CHECK(snapshot.gameState != GameState::GAME_LOST);
+
+            board.takeDelta(delta);
+            auto tile = delta.tiles.begin();
+            for (auto const& run: delta.runs)
+                for (auto i: std::views::iota(run.first, run.first + run.length))
+                    seen[i] = *tile++;
+            for (auto i: std::views::iota(size_t {0}, seen.size()))
+                CHECK((seen[i] & TILE_STATE_MASK) == (snapshot.tiles[i] & TILE_STATE_MASK));
+
+            if (board.getEndgamePosition(position))
+                checkEndgame(view, position);
+        }
+    }
+}
+
+// Seconds spent inside the board while the bot plays numGames, handling input
+//   and publishing the way the simulation does
+template<typename Board>
+static double timeGames(Board& board, int32_t numGames)
+{
+    std::mt19937 rng {2};
+    BoardSnapshot snapshot;
+    ExpertView view {snapshot};
+
+    std::chrono::steady_clock::duration elapsed {0};
+    for ([[maybe_unused]] auto game: std::views::iota(0, numGames))
+    {
+        auto start = std::chrono::steady_clock::now();
+        board.initialize();
+        board.publish(snapshot);
+        elapsed += std::chrono::steady_clock::now() - start;
+
+        while (auto move = chooseBotMove(view, rng))
+        {
+            auto x = static_cast<float>(move->x);
+            auto y = static_cast<float>(move->y);
+            start  = std::chrono::steady_clock::now();
+            board.telegraph(x, y);
+            board.clearTelegraph();
+            board.interact(x, y, move->button);
+            while (board.advanceReveal(4096))
+                ;
+            board.publish(snapshot);
+            elapsed += std::chrono::steady_clock::now() - start;
+        }
+    }
+
+    return std::chrono::duration<double>(elapsed).count();
+}
+
+int main()
+{
+    checkGames(100);
+
+    // The simulation plays the Expert preset on a BitBoard, which should beat
+    //   the GameBoard it replaced
+    constexpr int32_t NUM_GAMES {1000};
+    GameBoard gameBoard {ExpertBoard::BOARD_WIDTH, ExpertBoard::BOARD_HEIGHT, ExpertBoard::MINE_COUNT};
+    ExpertBoard bitBoard;
+    auto gameBoardTime = timeGames(gameBoard, NUM_GAMES);
+    auto bitBoardTime  = timeGames(bitBoard, NUM_GAMES);
+    std::cout << "Expert games: GameBoard " << 1e6 * gameBoardTime / NUM_GAMES << " us, BitBoard "
+              << 1e6 * bitBoardTime / NUM_GAMES << " us" << std::endl;
+    CHECK(bitBoardTime < gameBoardTime);
+
+    return testResult();
+}
@@ -0,0 +1,25 @@
+#pragma once
+
+#include <cstdlib>
+#include <iostream>
+
+// Failed checks are reported and counted rather than stopping the test, so
+//   one run shows everything that is wrong
+inline int numFailedChecks {0};
+
+#define CHECK(condition)                                                                              \
+    do                                                                                                \
+    {                                                                                                 \
+        if (!(condition))                                                                             \
+        {                                                                                             \
+            std::cerr << __FILE__ << ":" << __LINE__ << ": check failed: " << #condition << std::endl; \
+            numFailedChecks++;                                                                        \
+        }                                                                                             \
+    } while (false)
+
+inline int testResult()
+{
+    if (numFailedChecks > 0)
+        std::cerr << numFailedChecks << " checks failed" << std::endl;
+    return numFailedChecks == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
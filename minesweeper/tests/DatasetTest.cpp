@@ -0,0 +1,144 @@
+#include "BitBoard.h"
+#include "Bot.h"
+#include "Dataset.h"
+#include "EndgameSolver.h"
+#include "Minesweeper.h"
+
+#include "Check.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <ranges>
+#include <tuple>
+#include <vector>
+
+using Board = ExpertBoard;
+
+constexpr int32_t NUM_TILES {Board::BOARD_WIDTH * Board::BOARD_HEIGHT};
+
+// What a record should read back as, taken straight from the board
+static DatasetRecord expectRecord(Board const& board, uint32_t game, BotMove move, EndgameResult const& endgame)
+{
+    DatasetRecord record {game, move.x + move.y * Board::BOARD_WIDTH, move.button, {}, {}, endgame};
+    // Only what the file keeps of a position the solver never saw
+    if (!endgame.solved)
+        record.endgame = {false, endgame.exact, 0, -1, -1};
+    for (auto tile: std::views::iota(0, NUM_TILES))
+    {
+        auto x = tile % Board::BOARD_WIDTH;
+        auto y = tile / Board::BOARD_WIDTH;
+        switch (board.getTileState(x, y))
+        {
+        case TileState::UNCOVERED:
+            record.tiles.push_back(static_cast<uint8_t>(board.getMineCount(x, y)));
+            break;
+        case TileState::FLAGGED:
+            record.tiles.push_back(DatasetChunk::TILE_FLAGGED);
+            break;
+        case TileState::COVERED:
+            record.tiles.push_back(DatasetChunk::TILE_COVERED);
+            break;
+        }
+        record.mines.push_back(board.isMine(x, y) ? 1 : 0);
+    }
+    return record;
+}
+
+// Records bot games the way the dataset tool does, returning what was recorded
+static std::vector<DatasetRecord> writeGames(std::filesystem::path const& path, int32_t numGames)
+{
+    std::vector<DatasetRecord> expected;
+    DatasetWriter writer {path, Board::BOARD_WIDTH, Board::BOARD_HEIGHT, Board::MINE_COUNT};
+    CHECK(writer.isOpen());
+
+    Board board;
+    DatasetChunk chunk {NUM_TILES};
+    EndgameSolver solver;
+    EndgamePosition position;
+    std::minstd_rand rng {1};
+    for (auto game: std::views::iota(0, numGames))
+    {
+        board.initialize();
+        while (auto move = chooseBotMove(board, rng))
+        {
+            if (board.getGameState() == GameState::GAME_ONGOING)
+            {
+                EndgameResult endgame;
+                if (board.getEndgamePosition(position))
+                    endgame = solver.solve(position, std::chrono::milliseconds {2}, [] { return false; });
+                chunk.add(board, static_cast<uint32_t>(game), *move, endgame);
+                expected.push_back(expectRecord(board, static_cast<uint32_t>(game), *move, endgame));
+                if (chunk.isFull())
+                    writer.push(chunk.encode());
+            }
+            board.interact(move->x, move->y, move->button);
+        }
+    }
+    if (!chunk.isEmpty())
+        writer.push(chunk.encode());
+    writer.finish();
+    CHECK(!writer.failed());
+
+    return expected;
+}
+
+static std::vector<DatasetRecord> readAll(std::filesystem::path const& path)
+{
+    DatasetReader reader {path};
+    CHECK(reader.isOpen());
+    CHECK(reader.getBoardConfig() == std::make_tuple(Board::BOARD_WIDTH, Board::BOARD_HEIGHT, Board::MINE_COUNT));
+
+    std::vector<DatasetRecord> all;
+    std::vector<DatasetRecord> records;
+    while (reader.read(records))
+        all.insert(all.end(), records.begin(), records.end());
+    return all;
+}
+
+static bool sameRecord(DatasetRecord const& a, DatasetRecord const& b)
+{
+    return a.game == b.game and a.tile == b.tile and a.button == b.button and a.tiles == b.tiles and
+           a.mines == b.mines and a.endgame.solved == b.endgame.solved and a.endgame.exact == b.endgame.exact and
+           std::abs(a.endgame.winProbability - b.endgame.winProbability) <= 0.5f / 65535 and
+           a.endgame.bestX == b.endgame.bestX and a.endgame.bestY == b.endgame.bestY;
+}
+
+int main()
+{
+    auto path     = std::filesystem::temp_directory_path() / "minesweeper-dataset-test.msds";
+    auto expected = writeGames(path, 200);
+    // Enough records for several chunks, and endgames for the solver
+    CHECK(expected.size() > 2 * DatasetChunk::CAPACITY);
+    CHECK(std::ranges::any_of(expected, [](DatasetRecord const& record) { return record.endgame.solved; }));
+
+    auto decoded = readAll(path);
+    CHECK(decoded.size() == expected.size());
+    for (auto i: std::views::iota(size_t {0}, std::min(decoded.size(), expected.size())))
+        CHECK(sameRecord(decoded[i], expected[i]));
+
+    // A file cut short keeps the chunks before the cut and drops the rest
+    std::filesystem::resize_file(path, std::filesystem::file_size(path) - 100);
+    auto truncated = readAll(path);
+    CHECK(truncated.size() < expected.size());
+    CHECK(truncated.size() % DatasetChunk::CAPACITY == 0);
+    for (auto i: std::views::iota(size_t {0}, truncated.size()))
+        CHECK(sameRecord(truncated[i], expected[i]));
+
+    // A column claiming more bytes than it could ever need is rejected before
+    //   anything is allocated for it. The first column's size follows the
+    //   14-byte header and the chunk's record count.
+    {
+        std::fstream file {path, std::ios::binary | std::ios::in | std::ios::out};
+        file.seekp(18);
+        file.write("\xff\xff\xff\xff", 4);
+    }
+    CHECK(readAll(path).empty());
+
+    std::filesystem::remove(path);
+    return testResult();
+}
@@ -0,0 +1,163 @@
+#include "BitBoard.h"
+#include "Bot.h"
+#include "DeltaSink.h"
+#include "Minesweeper.h"
+
+#include "Check.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <filesystem>
+#include <random>
+#include <ranges>
+#include <vector>
+
+// Lets the bot play from a snapshot, so it plays GameBoard and BitBoard alike
+struct SnapshotView
+{
+    static constexpr int32_t BOARD_WIDTH {ExpertBoard::BOARD_WIDTH};
+    static constexpr int32_t BOARD_HEIGHT {ExpertBoard::BOARD_HEIGHT};
+
+    BoardSnapshot const& snapshot;
+
+    GameState getGameState() const
+    {
+        return this->snapshot.gameState;
+    }
+
+    TileState getTileState(int32_t x, int32_t y) const
+    {
+        auto tile = this->snapshot.tiles[x + y * BOARD_WIDTH];
+        return static_cast<TileState>((tile & TILE_STATE_MASK) >> TILE_STATE_SHIFT);
+    }
+
+    int32_t getMineCount(int32_t x, int32_t y) const
+    {
+        return this->snapshot.tiles[x + y * BOARD_WIDTH] & TILE_COUNT_MASK;
+    }
+};
+
+// What a viewer should have after every delta: the published tiles, minus
+//   whatever the stream keeps hidden until the game is lost
+static std::vector<uint8_t> expectTiles(BoardSnapshot const& snapshot)
+{
+    std::vector<uint8_t> tiles;
+    for (auto tile: snapshot.tiles)
+    {
+        tile &= ~TILE_TELEGRAPH_BIT;
+        auto state = (tile & TILE_STATE_MASK) >> TILE_STATE_SHIFT;
+        if (state == static_cast<uint8_t>(TileState::UNCOVERED))
+            tiles.push_back(tile);
+        else if (snapshot.gameState != GameState::GAME_LOST)
+            tiles.push_back(tile & TILE_STATE_MASK);
+        // Once lost, the stream shows the mines and the flags, but not the
+        //   numbers under covered tiles
+        else if (state == static_cast<uint8_t>(TileState::FLAGGED) or (tile & TILE_MINE_BIT))
+            tiles.push_back(tile);
+        else
+            tiles.push_back(tile & TILE_STATE_MASK);
+    }
+    return tiles;
+}
+
+struct Recording
+{
+    std::vector<BoardDelta> deltas;
+    std::vector<std::vector<uint8_t>> expected;
+};
+
+// Plays bot games on a board, streaming its deltas to a file the way the
+//   simulation does and keeping what was sent and what was published
+template<typename Board>
+static Recording recordGames(Board& board, std::filesystem::path const& path, int32_t numGames)
+{
+    Recording recording;
+    StreamDeltaSink sink {path};
+    CHECK(sink.isOpen());
+
+    std::mt19937 rng {1};
+    BoardSnapshot snapshot;
+    SnapshotView view {snapshot};
+    BoardDelta delta;
+    board.setRecordingChanges(true);
+    auto publish = [&](bool newGame)
+    {
+        board.publish(snapshot);
+        if (!board.takeDelta(delta) and !newGame)
+            return;
+        delta.sequence = recording.deltas.size() + 1;
+        delta.newGame  = newGame;
+        sink.publish(delta);
+        recording.deltas.push_back(delta);
+        recording.expected.push_back(expectTiles(snapshot));
+    };
+
+    for ([[maybe_unused]] auto game: std::views::iota(0, numGames))
+    {
+        board.initialize();
+        publish(true);
+        while (auto move = chooseBotMove(view, rng))
+        {
+            board.interact(static_cast<float>(move->x), static_cast<float>(move->y), move->button);
+            while (board.advanceReveal(64))
+                publish(false);
+            publish(false);
+        }
+    }
+
+    return recording;
+}
+
+static bool sameDelta(BoardDelta const& a, BoardDelta const& b)
+{
+    auto sameRun = [](BoardDelta::Run const& x, BoardDelta::Run const& y)
+    { return x.first == y.first and x.length == y.length; };
+    return a.sequence == b.sequence and a.newGame == b.newGame and a.boardWidth == b.boardWidth and
+           a.boardHeight == b.boardHeight and a.mineCount == b.mineCount and a.topology == b.topology and
+           a.gameState == b.gameState and a.lastClicked == b.lastClicked and a.tiles == b.tiles and
+           std::ranges::equal(a.runs, b.runs, sameRun);
+}
+
+// Reads the stream back, checking every delta decodes to the one sent and
+//   rebuilds what the board published
+static void checkReplay(Recording const& recording, std::filesystem::path const& path)
+{
+    DeltaReader reader {path};
+    CHECK(reader.isOpen());
+
+    BoardDelta delta;
+    std::vector<uint8_t> tiles;
+    size_t numRead = 0;
+    for (; numRead < recording.deltas.size() and reader.read(delta); numRead++)
+    {
+        CHECK(sameDelta(delta, recording.deltas[numRead]));
+        applyDelta(delta, tiles);
+        CHECK(tiles == recording.expected[numRead]);
+    }
+    CHECK(numRead == recording.deltas.size());
+    CHECK(!reader.read(delta));
+}
+
+int main()
+{
+    auto path = std::filesystem::temp_directory_path() / "minesweeper-delta-test.bin";
+
+    GameBoard gameBoard {ExpertBoard::BOARD_WIDTH, ExpertBoard::BOARD_HEIGHT, ExpertBoard::MINE_COUNT};
+    checkReplay(recordGames(gameBoard, path, 200), path);
+
+    ExpertBoard bitBoard;
+    checkReplay(recordGames(bitBoard, path, 200), path);
+
+    // A stream cut off mid-delta ends before it
+    auto recording = recordGames(bitBoard, path, 10);
+    std::filesystem::resize_file(path, std::filesystem::file_size(path) - 1);
+    DeltaReader reader {path};
+    BoardDelta delta;
+    size_t numRead = 0;
+    while (reader.read(delta))
+        numRead++;
+    CHECK(numRead == recording.deltas.size() - 1);
+
+    std::filesystem::remove(path);
+    return testResult();
+}